@@ -0,0 +1,100 @@
+// 호스트(Linux) 빌드용 Arduino/ESP-IDF 전역 객체와 시간 함수
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <WiFi.h>
+#include <Wire.h>
+#include <Update.h>
+#include <esp_timer.h>
+#include <freertos/task.h>
+#include <freertos/event_groups.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+HWSerial Serial;
+EspClass ESP;
+fs::FS LittleFS;
+WiFiClass WiFi;
+TwoWire Wire;
+UpdateClass Update;
+size_t hostHeapUsed = 0;
+uint32_t hostRestarts = 0;
+uint32_t hostWdtResets = 0;
+bool hostPinLow[64];
+
+static const auto hostStart = std::chrono::steady_clock::now();
+static time_t hostEpoch = 0;
+static bool hostMillisFixed = false;
+static uint32_t hostMillisValue = 0;
+
+unsigned long micros() {
+  return (unsigned long)(uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - hostStart).count();
+}
+
+unsigned long millis() {
+  if (hostMillisFixed) return hostMillisValue;
+  return (unsigned long)(uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - hostStart).count();
+}
+
+void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+void delayMicroseconds(unsigned us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+void vTaskDelay(TickType_t ticks) { delay(ticks * portTICK_PERIOD_MS); }
+int64_t esp_timer_get_time() { return (int64_t)micros(); }
+
+struct HostEventGroup {
+  std::mutex m;
+  std::condition_variable cv;
+  EventBits_t bits = 0;
+};
+
+EventGroupHandle_t xEventGroupCreate() { return new HostEventGroup; }
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+  HostEventGroup* g = (HostEventGroup*)group;
+  std::lock_guard<std::mutex> lock(g->m);
+  g->bits |= bits;
+  g->cv.notify_all();
+  return g->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+  HostEventGroup* g = (HostEventGroup*)group;
+  std::lock_guard<std::mutex> lock(g->m);
+  EventBits_t before = g->bits;
+  g->bits &= ~bits;
+  return before;
+}
+
+// FreeRTOS 와 같이 반환값은 깨어난 (또는 시간이 다 된) 시점의 비트
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clearOnExit, BaseType_t waitAll, TickType_t ticks) {
+  HostEventGroup* g = (HostEventGroup*)group;
+  std::unique_lock<std::mutex> lock(g->m);
+  auto ready = [&] { return waitAll ? (g->bits & bits) == bits : (g->bits & bits) != 0; };
+  g->cv.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), ready);
+  EventBits_t result = g->bits;
+  if (ready() && clearOnExit) g->bits &= ~bits;
+  return result;
+}
+
+void hostSetEpoch(time_t epoch) { hostEpoch = epoch; }
+void hostSetMillis(uint32_t ms) { hostMillisFixed = true; hostMillisValue = ms; }
+void hostClearMillis() { hostMillisFixed = false; }
+
+// 펌웨어의 time(nullptr) (NTP 로 맞춘 시계) 대신: hostSetEpoch() 값이 있으면 그 시각으로 고정
+extern "C" time_t time(time_t* t) noexcept {
+  time_t now = hostEpoch;
+  if (now == 0) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    now = ts.tv_sec;
+  }
+  if (t) *t = now;
+  return now;
+}
+
+bool getLocalTime(struct tm* info, uint32_t) {
+  time_t now = time(nullptr);
+  gmtime_r(&now, info);
+  return true;
+}
@@ -0,0 +1,126 @@
+// 호스트 그래프 좌표 테스트 (예전 /debug/graphbench 를 옮김): 세로/가로 레이아웃 x 4개 모드 (1,6,12,24H)
+//   graphColumnFor / graphColumnOf 가 64비트 식 ts * w / window 와 비트 단위로 같은지
+//   graphColumnStartTsFor 가 그 컬럼의 첫 시각인지 (ceil(col * window / w))
+//   graphValueY (Q16) 가 예전 float 경로 (rec.temp / 10.0f) 와 1px 이내인지
+// 끝에 예전 float 경로와 정수 경로의 시간 (호스트 CPU 기준, 참고용)
+#include "../main_v25.cpp"
+#include <chrono>
+
+static int failures = 0, checks = 0;
+
+static void check(bool ok, const char* what) {
+  checks++;
+  if (ok) { printf("ok   %s\n", what); return; }
+  printf("FAIL %s\n", what);
+  failures++;
+}
+
+static const uint32_t TEST_EPOCH = 1767258000;                  // render_test 와 같은 시각
+
+static uint32_t exactColumn(uint32_t ts, uint32_t windowSec) {
+  return (uint32_t)((uint64_t)ts * layout->graph_w / windowSec);
+}
+
+// 전 범위를 소수 간격으로 + 지금 시각과 2^32 바로 앞에서 2 구간은 1초 단위로
+static void testColumns(int rot, int mode) {
+  char what[96];
+  uint32_t windowSec = graphWindowSec(mode);
+  uint32_t bad = 0, n = 0;
+  auto one = [&](uint32_t ts) {
+    n++;
+    if (graphColumnFor(ts, windowSec) != exactColumn(ts, windowSec)) bad++;
+  };
+  for (uint64_t ts = 0; ts <= 0xFFFFFFFFull; ts += 9973) one((uint32_t)ts);
+  uint32_t base = TEST_EPOCH - TEST_EPOCH % windowSec;
+  for (uint32_t d = 0; d < 2 * windowSec; d++) one(base + d);
+  for (uint32_t d = 1; d <= 2 * windowSec; d++) one(0xFFFFFFFFu - 2 * windowSec + d);
+  snprintf(what, sizeof(what), "column rot%d %2dH: graphColumnFor == ts*w/window (%u ts, %u differ)", rot, displayHoursOptions[mode], n, bad);
+  check(bad == 0, what);
+
+  displayHoursIndex = mode;
+  check(graphColumnOf(TEST_EPOCH) == exactColumn(TEST_EPOCH, windowSec), "column: graphColumnOf uses the current mode");
+
+  // 컬럼 시작 시각: 그 시각은 컬럼 c, 1초 전은 c-1
+  bad = 0;
+  uint32_t col0 = exactColumn(TEST_EPOCH, windowSec);
+  for (uint32_t c = col0 - 2 * layout->graph_w; c <= col0; c++) {
+    uint32_t t = graphColumnStartTsFor(c, windowSec);
+    if (exactColumn(t, windowSec) != c || exactColumn(t - 1, windowSec) != c - 1) bad++;
+  }
+  snprintf(what, sizeof(what), "column rot%d %2dH: graphColumnStartTsFor is the first second of its column", rot, displayHoursOptions[mode]);
+  check(bad == 0, what);
+}
+
+// 예전 float 경로 (secondsPerPixel 나눗셈 + rec.temp / 10.0f, 지운 /debug/graphbench 와 같은 식)
+static int legacyValueY(GraphSeries s, int16_t v10) {
+  float yMin = graphYAxis[s].lo10 / 10.0f;
+  float scale = (float)layout->graph_h / ((graphYAxis[s].hi10 - graphYAxis[s].lo10) / 10.0f);
+  return constrain(layout->graph_h - (int)(((v10 / 10.0f) - yMin) * scale + 0.5f), 0, layout->graph_h - 1);
+}
+
+// 자동 조정으로 나올 수 있는 축 몇 가지에서 축 범위 +-5도의 모든 0.1 값
+static void testValueY(int rot) {
+  static const int16_t RANGES[][2] = { { 260, 300 }, { 500, 700 }, { 275, 281 }, { 0, 800 }, { -50, 120 } };
+  char what[96];
+  uint32_t offByOne = 0, worse = 0, n = 0;
+  for (const auto &r : RANGES) {
+    int16_t lo[NUM_GRAPH_SERIES] = { r[0], r[0] }, hi[NUM_GRAPH_SERIES] = { r[1], r[1] };
+    graphYAxisFit(lo, hi);
+    updateGraphYScale();                                        // 레이아웃이 바뀐 뒤 축이 그대로면 Fit 이 배율을 다시 계산하지 않음
+    for (int s = 0; s < NUM_GRAPH_SERIES; s++) {
+      for (int v = graphYAxis[s].lo10 - 50; v <= graphYAxis[s].hi10 + 50; v++) {
+        int d = abs(graphValueY((GraphSeries)s, (int16_t)v) - legacyValueY((GraphSeries)s, (int16_t)v));
+        n++;
+        if (d == 1) offByOne++;
+        if (d > 1) worse++;
+      }
+    }
+  }
+  snprintf(what, sizeof(what), "value rot%d: graphValueY within 1px of the float path (%u values, %u off by 1)", rot, n, offByOne);
+  check(worse == 0, what);
+}
+
+// 참고용 시간: 24시간 분량 레코드를 두 경로로 변환
+static void benchModes() {
+  static LogRecord recs[DISPLAY_MAX_SAMPLES];
+  for (int i = 0; i < DISPLAY_MAX_SAMPLES; i++) {
+    recs[i].ts = TEST_EPOCH - (DISPLAY_MAX_SAMPLES - 1 - i) * GRAPH_SAMPLE_INTERVAL_SEC;
+    recs[i].temp = 260 + i % 40;
+    recs[i].humi_act = packHumi(500 + i % 200, 0);
+  }
+  const int REPS = 20;
+  volatile int32_t sink = 0;
+  printf("rot  mode  float_us  int_us  speedup   (%d records x %d)\n", DISPLAY_MAX_SAMPLES, REPS);
+  for (int m = 0; m < NUM_GRAPH_MODES; m++) {
+    uint32_t windowSec = graphWindowSec(m);
+    float spp = (float)windowSec / layout->graph_w;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPS; r++)
+      for (const LogRecord &rec : recs)
+        sink += layout->graph_w - (int)((float)(TEST_EPOCH - rec.ts) / spp) + legacyValueY(GS_TEMP, rec.temp) + legacyValueY(GS_HUMI, recHumi(rec));
+    auto t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPS; r++)
+      for (const LogRecord &rec : recs)
+        sink += (int)graphColumnFor(rec.ts, windowSec) + graphValueY(GS_TEMP, rec.temp) + graphValueY(GS_HUMI, recHumi(rec));
+    auto t2 = std::chrono::steady_clock::now();
+    long floatUs = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+    long intUs = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+    printf("%3d  %3dH  %8ld  %6ld  %6.2fx\n", (int)(layout - SCREEN_LAYOUTS), displayHoursOptions[m], floatUs, intUs,
+           intUs ? (double)floatUs / intUs : 0.0);
+  }
+}
+
+int main() {
+  for (int rot = 0; rot < 2; rot++) {
+    layout = &SCREEN_LAYOUTS[rot];                              // 좌표 계산은 레이아웃의 그래프 크기만 봄
+    for (int m = 0; m < NUM_GRAPH_MODES; m++) testColumns(rot, m);
+    testValueY(rot);
+  }
+  for (int rot = 0; rot < 2; rot++) {
+    layout = &SCREEN_LAYOUTS[rot];
+    updateGraphYScale();
+    benchModes();
+  }
+  printf("%d/%d checks pass\n", checks - failures, checks);
+  return failures ? 1 : 0;
+}
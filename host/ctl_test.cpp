@@ -0,0 +1,78 @@
+// 호스트 제어 명령 대기 테스트: 웹 핸들러의 ctlWaitApplied() 가 다른 태스크 (여기서는 스레드) 의 applyCtlCmd() 를
+// 이벤트 비트로 기다렸다가 바로 돌아오는지, 시간 안에 적용되지 않으면 false (핸들러는 503) 인지
+#include "../main_v25.cpp"
+#include <thread>
+
+static int failures = 0, checks = 0;
+
+static void check(bool ok, const char* what) {
+  checks++;
+  if (ok) { printf("ok   %s\n", what); return; }
+  printf("FAIL %s\n", what);
+  failures++;
+}
+
+// delayMs 뒤에 controlTask 처럼 명령을 count 개 적용
+static std::thread applyLater(uint32_t delayMs, int count) {
+  return std::thread([=] {
+    for (int i = 0; i < count; i++) {
+      delay(delayMs);
+      applyCtlCmd({ ACT_FAN, i % 2 ? OFF : ON });
+    }
+  });
+}
+
+static void testAlreadyApplied() {
+  uint32_t target = ctlCmdsApplied.load();
+  unsigned long t0 = millis();
+  check(ctlWaitApplied(target, 200) && millis() - t0 < 5, "wait: nothing to wait for -> true at once");
+}
+
+static void testAppliedLater() {
+  uint32_t target = ctlCmdsApplied.load() + 1;
+  unsigned long t0 = millis();
+  std::thread t = applyLater(30, 1);
+  bool ok = ctlWaitApplied(target, CTL_APPLY_TIMEOUT_MS);
+  unsigned long waited = millis() - t0;
+  t.join();
+  char what[96];
+  snprintf(what, sizeof(what), "wait: woken when applied (%lu ms, applied after 30)", waited);
+  check(ok && waited >= 30 && waited < 30 + 20, what);
+}
+
+// 앞 명령이 세운 비트로 깨어나도 두 번째 명령까지 기다림
+static void testTwoCommands() {
+  uint32_t target = ctlCmdsApplied.load() + 2;
+  unsigned long t0 = millis();
+  std::thread t = applyLater(20, 2);
+  bool ok = ctlWaitApplied(target, CTL_APPLY_TIMEOUT_MS);
+  unsigned long waited = millis() - t0;
+  t.join();
+  check(ok && waited >= 40 && (int32_t)(ctlCmdsApplied.load() - target) >= 0, "wait: two commands -> waits for both");
+}
+
+static void testTimeout() {
+  uint32_t target = ctlCmdsApplied.load() + 1;
+  unsigned long t0 = millis();
+  bool ok = ctlWaitApplied(target, 50);
+  unsigned long waited = millis() - t0;
+  check(!ok && waited >= 50 && waited < 50 + 20, "wait: not applied -> false after the timeout");
+}
+
+static void testStaleBit() {
+  applyCtlCmd({ ACT_FAN, OFF });                                // 기다리기 전에 세워진 비트
+  uint32_t target = ctlCmdsApplied.load() + 1;
+  bool ok = ctlWaitApplied(target, 50);
+  check(!ok, "wait: a stale bit does not count as applied");
+}
+
+int main() {
+  ctlAppliedEvents = xEventGroupCreate();                       // startControlTask() 와 같이
+  testAlreadyApplied();
+  testAppliedLater();
+  testTwoCommands();
+  testTimeout();
+  testStaleBit();
+  printf("%d/%d checks pass\n", checks - failures, checks);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,143 @@
+// 호스트 그래프 데이터 피드 테스트: /graphdata?fmt=bin (handleGraphDataBin) 의 슬롯 값이
+// 구간 안 모든 레코드의 평균 (temp/humi 같은 구간, 센서 오류 값만 빠짐) 인지 레코드를 직접 평균 낸 값과 비교
+#include "../main_v25.cpp"
+#include <cmath>
+
+static int failures = 0, checks = 0;
+
+static void check(bool ok, const char* what) {
+  checks++;
+  if (ok) { printf("ok   %s\n", what); return; }
+  printf("FAIL %s\n", what);
+  failures++;
+}
+
+static const uint32_t TEST_EPOCH = 1767258000;                  // render_test 와 같은 시각
+
+// 24시간: 온도는 영하를 지나는 톱니파, 습도는 다른 주기, 중간중간 온도만/습도만/둘 다 무효
+static void seed() {
+  initDisplayBuffer();
+  for (int i = 0; i < DISPLAY_MAX_SAMPLES; i++) {
+    LogRecord &rec = displayLogBuf[i];
+    int back = DISPLAY_MAX_SAMPLES - 1 - i;
+    rec.ts = TEST_EPOCH - back * GRAPH_SAMPLE_INTERVAL_SEC;
+    int16_t t10 = (int16_t)(-40 + (i * 7) % 173);
+    int16_t h10 = (int16_t)(400 + (i * 13) % 311);
+    if (i % 97 == 5) t10 = INVALID_VALUE;
+    if (i % 89 == 3) h10 = INVALID_VALUE;
+    if (back >= 600 && back < 640) { t10 = INVALID_VALUE; h10 = INVALID_VALUE; }
+    rec.temp = t10;
+    rec.humi_act = packHumi(h10, i % 50 == 0 ? ACT_FAN : 0);
+  }
+  displayLogIndex = 0;
+  isDisplayBufferFull = true;
+}
+
+struct Feed {
+  int32_t base, interval;
+  std::vector<int16_t> temp, humi;
+  std::vector<uint8_t> act;
+};
+
+static Feed fetch(int hours, uint32_t since = 0, uint32_t before = 0) {
+  handleGraphDataBin(hours, since, before, true);
+  const std::string &b = server.hostContent;
+  Feed f = {};
+  size_t n = (b.size() - 8) / 5;
+  memcpy(&f.base, b.data(), 4);
+  memcpy(&f.interval, b.data() + 4, 4);
+  f.temp.resize(n); f.humi.resize(n); f.act.resize(n);
+  memcpy(f.temp.data(), b.data() + 8, n * 2);
+  memcpy(f.humi.data(), b.data() + 8 + n * 2, n * 2);
+  memcpy(f.act.data(), b.data() + 8 + n * 4, n);
+  return f;
+}
+
+// 슬롯 i 구간 (t - interval, t] 의 레코드를 직접 평균 (반올림은 0 에서 먼 쪽)
+static void expected(const Feed &f, size_t i, uint32_t since, int16_t &t, int16_t &h, uint8_t &a) {
+  uint32_t hiTs = f.base + i * f.interval, loTs = hiTs - f.interval;
+  double ts = 0, hs = 0;
+  int tn = 0, hn = 0;
+  a = 0;
+  for (const LogRecord &rec : displayLogBuf) {
+    if (rec.ts <= loTs || rec.ts > hiTs || rec.ts <= since) continue;
+    if (rec.temp != INVALID_VALUE) { ts += rec.temp; tn++; }
+    if (recHumi(rec) != INVALID_VALUE) { hs += recHumi(rec); hn++; }
+    a |= recActuators(rec);
+  }
+  t = tn ? (int16_t)std::lround(ts / tn) : (int16_t)INVALID_VALUE;
+  h = hn ? (int16_t)std::lround(hs / hn) : (int16_t)INVALID_VALUE;
+}
+
+static int mismatches(const Feed &f, uint32_t since = 0) {
+  int bad = 0;
+  for (size_t i = 0; i < f.temp.size(); i++) {
+    int16_t t, h;
+    uint8_t a;
+    expected(f, i, since, t, h, a);
+    if (f.temp[i] != t || f.humi[i] != h || f.act[i] != a) {
+      if (bad < 3) printf("     slot %zu: got %d/%d/%u, want %d/%d/%u\n", i, f.temp[i], f.humi[i], f.act[i], t, h, a);
+      bad++;
+    }
+  }
+  return bad;
+}
+
+static void testModes() {
+  static const int HOURS[] = { 1, 6, 12, 24 };
+  char what[96];
+  for (int hours : HOURS) {
+    Feed f = fetch(hours);
+    int bad = mismatches(f);
+    snprintf(what, sizeof(what), "%2dH: %zu slots x %d s, every slot is the mean of its records (%d differ)",
+             hours, f.temp.size(), f.interval, bad);
+    check(f.base + (int32_t)(f.temp.size() - 1) * f.interval == (int32_t)TEST_EPOCH && bad == 0, what);
+  }
+}
+
+// 1H 는 슬롯 = 기록 간격 -> 레코드 값 그대로
+static void testOneRecordPerSlot() {
+  Feed f = fetch(1);
+  bool same = f.interval == GRAPH_SAMPLE_INTERVAL_SEC;
+  for (size_t i = 0; i < f.temp.size() && same; i++) {
+    const LogRecord &rec = displayLogBuf[DISPLAY_MAX_SAMPLES - f.temp.size() + i];
+    same = rec.ts == (uint32_t)(f.base + i * f.interval) && rec.temp == f.temp[i] && recHumi(rec) == f.humi[i];
+  }
+  check(same, "1H: one record per slot -> the record's own values");
+}
+
+// 슬롯의 최근 레코드 하나만 튀어도 슬롯 값은 평균만큼만 움직임 (예전: 최근 값 그대로)
+static void testSpikeAveraged() {
+  for (int i = 0; i < DISPLAY_MAX_SAMPLES; i++) { displayLogBuf[i].temp = 250; displayLogBuf[i].humi_act = packHumi(600, 0); }
+  LogRecord &last = displayLogBuf[DISPLAY_MAX_SAMPLES - 1];
+  last.temp = 250 + 240;
+  last.humi_act = packHumi(INVALID_VALUE, 0);                   // 습도 센서만 오류
+  Feed f = fetch(24);
+  int perSlot = f.interval / GRAPH_SAMPLE_INTERVAL_SEC;
+  char what[96];
+  snprintf(what, sizeof(what), "spike: last slot temp %d = 250 + 240 / %d records, humi from the other records", f.temp.back(), perSlot);
+  check(f.temp.back() == 250 + (240 + perSlot / 2) / perSlot && f.humi.back() == 600, what);
+  seed();
+}
+
+static void testSinceBefore() {
+  uint32_t since = TEST_EPOCH - 3 * 3600 - 5;
+  Feed f = fetch(24, since);
+  int bad = mismatches(f, since);
+  check(f.base - f.interval < (int32_t)since + f.interval && bad == 0, "since: only records after since, averaged");
+
+  uint32_t before = TEST_EPOCH - 6 * 3600;
+  f = fetch(6, 0, before);
+  bad = mismatches(f);
+  check(f.base + (int32_t)(f.temp.size() - 1) * f.interval == (int32_t)before - 1 && bad == 0, "before: window ends before, averaged");
+}
+
+int main() {
+  seed();
+  testModes();
+  testOneRecordPerSlot();
+  testSpikeAveraged();
+  testSinceBefore();
+  printf("%d/%d checks pass\n", checks - failures, checks);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,10 @@
+// 호스트 빌드용 AHTX0 라이브러리 대체
+#pragma once
+#include <Wire.h>
+struct sensors_event_t { float temperature; float relative_humidity; };
+class Adafruit_AHTX0 {
+public:
+  bool begin(TwoWire* = nullptr, int32_t = 0, uint8_t = 0x38) { return false; }
+  bool getEvent(sensors_event_t*, sensors_event_t*) { return false; }
+  uint8_t getStatus() { return 0xFF; }
+};
@@ -0,0 +1,7 @@
+// 호스트 빌드용 BMP280 라이브러리 대체
+#pragma once
+#include <Wire.h>
+class Adafruit_BMP280 {
+public:
+  bool begin(uint8_t = 0x77) { return false; }
+};
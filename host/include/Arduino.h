@@ -0,0 +1,129 @@
+// 호스트(Linux) 빌드용 Arduino 코어 대체 헤더
+// main_v25.cpp 가 쓰는 부분만 구현 (GPIO/PWM 은 아무 것도 하지 않음, 시간은 호스트 시계)
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <math.h>
+#include <cmath>
+#include <ctime>
+#include <string>
+#include <functional>
+#include <cstdarg>
+#include <algorithm>
+using std::min; using std::max; using std::isnan;
+typedef uint8_t byte;
+
+#define PROGMEM
+#define PGM_P const char*
+#define PI 3.14159265358979
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define INPUT_PULLUP 2
+#define OUTPUT 1
+#define IRAM_ATTR
+#define RISING 1
+#define FALLING 2
+#define CHANGE 3
+#define portMAX_DELAY 0xffffffff
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+inline size_t strlen_P(const char* s) { return strlen(s); }
+inline void* memcpy_P(void* d, const void* s, size_t n) { return memcpy(d, s, n); }
+
+class String {
+public:
+  std::string s;
+  String() {}
+  String(const char* c) : s(c ? c : "") {}
+  String(const __FlashStringHelper* c) : s((const char*)c) {}
+  String(int v) : s(std::to_string(v)) {}
+  String(unsigned v) : s(std::to_string(v)) {}
+  String(long v) : s(std::to_string(v)) {}
+  String(unsigned long v) : s(std::to_string(v)) {}
+  String(float v) { char b[32]; snprintf(b, sizeof(b), "%.2f", v); s = b; }
+  const char* c_str() const { return s.c_str(); }
+  size_t length() const { return s.size(); }
+  int toInt() const { return atoi(s.c_str()); }
+  String& operator+=(const String& o) { s += o.s; return *this; }
+  String& operator+=(const char* o) { s += o; return *this; }
+  bool operator==(const char* o) const { return s == o; }
+  bool operator==(const String& o) const { return s == o.s; }
+  bool operator!=(const char* o) const { return s != o; }
+  void toCharArray(char* b, size_t n) const { if (n) { strncpy(b, s.c_str(), n - 1); b[n - 1] = 0; } }
+  char operator[](size_t i) const { return i < s.size() ? s[i] : 0; }
+};
+inline String operator+(const String& a, const String& b) { String r = a; r += b; return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b) { String r = a; r += b; return r; }
+
+// 시간: millis/micros 는 호스트 단조 시계 (millis 는 hostSetMillis() 로 고정 가능: 스케줄러 테스트),
+//       time()/getLocalTime() 은 hostSetEpoch() 로 고정 가능 (골든 이미지 재현)
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned us);
+void hostSetEpoch(time_t epoch);              // 0 이면 실제 시계
+void hostSetMillis(uint32_t ms);              // 이후 millis() 는 이 값
+void hostClearMillis();                       // 다시 실제 시계
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+inline void configTime(long, int, const char*, const char*) {}
+
+// 입력 핀: hostSetPin() 으로 정한 값 (기본 HIGH = 풀업, 엔코더 테스트), 출력 (digitalWrite) 은 기록하지 않음
+extern bool hostPinLow[64];
+inline int digitalRead(int pin) { return (pin >= 0 && pin < 64 && hostPinLow[pin]) ? LOW : HIGH; }
+inline void hostSetPin(int pin, int level) { hostPinLow[pin] = level == LOW; }
+inline void digitalWrite(int, int) {}
+inline void pinMode(int, int) {}
+inline void yield() {}
+inline void ledcSetup(int, int, int) {}
+inline void ledcAttachPin(int, int) {}
+inline void ledcWrite(int, int) {}
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+template <class T, class A, class B> T constrain(T x, A a, B b) { return x < a ? a : (x > b ? b : x); }
+inline void attachInterrupt(int, void (*)(), int) {}
+inline int digitalPinToInterrupt(int p) { return p; }
+
+struct HWSerial {
+  void begin(long) {}
+  void println(const char* s) { printf("%s\n", s); }
+  void println(const String& s) { printf("%s\n", s.c_str()); }
+  void println() { printf("\n"); }
+  void print(const char* s) { printf("%s", s); }
+  int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    va_list ap; va_start(ap, fmt); int n = vprintf(fmt, ap); va_end(ap); return n;
+  }
+  void flush() { fflush(stdout); }
+};
+extern HWSerial Serial;
+
+// 호스트 힙: 스프라이트 버퍼/팔레트만 따짐 (그래프 스프라이트가 실제로 차지한 바이트 확인용)
+#define HOST_HEAP_FREE 200000
+extern size_t hostHeapUsed;
+extern uint32_t hostRestarts;                        // ESP.restart() 횟수 (호스트는 종료하지 않음)
+
+struct EspClass {
+  void restart() { hostRestarts++; }
+  uint32_t getFreeHeap() { return (uint32_t)(HOST_HEAP_FREE - hostHeapUsed); }
+  uint32_t getMinFreeHeap() { return 200000; }
+  uint32_t getMaxAllocHeap() { return 100000; }
+  uint32_t getHeapSize() { return 320000; }
+  uint32_t getCpuFreqMHz() { return 240; }
+  const char* getSdkVersion() { return "host"; }
+  uint32_t getFreeSketchSpace() { return 0; }
+  String getSketchMD5() { return String(); }
+};
+extern EspClass ESP;
+
+class IPAddress {
+public:
+  IPAddress() {}
+  IPAddress(int, int, int, int) {}
+  String toString() const { return String("0.0.0.0"); }
+};
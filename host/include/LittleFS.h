@@ -0,0 +1,26 @@
+// 호스트 빌드용 LittleFS 대체 (파일 없음: open 은 항상 실패)
+#pragma once
+#include <Arduino.h>
+namespace fs {
+class File {
+public:
+  operator bool() const { return false; }
+  size_t read(uint8_t*, size_t) { return 0; }
+  size_t write(const uint8_t*, size_t) { return 0; }
+  bool seek(uint32_t) { return false; }
+  size_t size() { return 0; }
+  size_t position() { return 0; }
+  void close() {}
+  void flush() {}
+};
+class FS {
+public:
+  bool begin(bool = false) { return true; }
+  bool exists(const char*) { return false; }
+  File open(const char*, const char*) { return File(); }
+  bool remove(const char*) { return false; }
+  size_t totalBytes() { return 0; }
+  size_t usedBytes() { return 0; }
+};
+}
+extern fs::FS LittleFS;
@@ -0,0 +1,15 @@
+// 호스트 빌드용 Preferences 대체 (항상 기본값)
+#pragma once
+#include <Arduino.h>
+class Preferences {
+public:
+  bool begin(const char*, bool = false) { return true; }
+  void end() {}
+  int getInt(const char*, int d = 0) { return d; }
+  size_t putInt(const char*, int) { return 0; }
+  String getString(const char*, const String& d = String()) { return d; }
+  size_t putString(const char*, const String&) { return 0; }
+  bool remove(const char*) { return true; }
+  uint32_t getUInt(const char*, uint32_t d = 0) { return d; }
+  size_t putUInt(const char*, uint32_t) { return 0; }
+};
@@ -0,0 +1,10 @@
+// 호스트 빌드용 SHT4x 라이브러리 대체
+#pragma once
+#include <Wire.h>
+class SensirionI2cSht4x {
+public:
+  void begin(TwoWire&, uint8_t) {}
+  int16_t softReset() { return 0; }
+  int16_t measureHighPrecision(float&, float&) { return -1; }
+  int16_t measureHighPrecisionTicks(uint16_t&, uint16_t&) { return -1; }
+};
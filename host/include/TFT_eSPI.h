@@ -0,0 +1,187 @@
+// 호스트(Linux) 빌드용 TFT_eSPI / TFT_eSprite 대체
+// main_v25.cpp 가 쓰는 부분만: 화면은 RGB565 프레임버퍼, 스프라이트는 라이브러리와 같은 메모리 배치
+// (16비트 = SPI 바이트 순서, 4비트 = 짝수 x 가 상위 니블, 1비트 = 줄마다 8픽셀 단위 MSB 먼저)
+// 글꼴: 기본(GLCD) 5x7 글꼴, FreeSansBold9pt7b/12pt7b 는 같은 5x7 글꼴을 확대해 만든 대체 글꼴
+// -> 글자 모양은 실제 FreeFont 와 다르지만 위치/폭/색/기준선 규칙은 같음 (골든 이미지는 배치와 색을 비교)
+// DMA: pushImageDMA 는 작업 스레드가 전송 시간(hostDmaNsPerPixel)만큼 기다린 뒤 버퍼를 프레임버퍼에 복사
+// -> 전송 중에 버퍼를 고치거나, 전송 중에 화면에 직접 그리면 (tftSync 누락) 화면/hostDmaErrors 에 드러남
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <vector>
+
+#ifndef TFT_WIDTH
+#define TFT_WIDTH 240
+#endif
+#ifndef TFT_HEIGHT
+#define TFT_HEIGHT 320
+#endif
+
+struct GFXglyph { uint32_t bitmapOffset; uint8_t width, height, xAdvance; int8_t xOffset, yOffset; };
+struct GFXfont { uint8_t* bitmap; GFXglyph* glyph; uint16_t first, last; uint8_t yAdvance; };
+extern const GFXfont FreeSansBold9pt7b, FreeSansBold12pt7b;
+
+#define TFT_BLACK       0x0000
+#define TFT_NAVY        0x000F
+#define TFT_DARKGREEN   0x03E0
+#define TFT_DARKCYAN    0x03EF
+#define TFT_MAROON      0x7800
+#define TFT_PURPLE      0x780F
+#define TFT_OLIVE       0x7BE0
+#define TFT_LIGHTGREY   0xD69A
+#define TFT_DARKGREY    0x7BEF
+#define TFT_BLUE        0x001F
+#define TFT_GREEN       0x07E0
+#define TFT_CYAN        0x07FF
+#define TFT_RED         0xF800
+#define TFT_MAGENTA     0xF81F
+#define TFT_YELLOW      0xFFE0
+#define TFT_WHITE       0xFFFF
+#define TFT_ORANGE      0xFDA0
+#define TFT_SILVER      0xC618
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+#define L_BASELINE 9
+
+class TFT_eSPI {
+public:
+  TFT_eSPI(int16_t w = (TFT_WIDTH), int16_t h = (TFT_HEIGHT));
+  virtual ~TFT_eSPI();
+
+  void init();
+  void setRotation(uint8_t r);
+  uint8_t getRotation() const { return rotation; }
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+
+  // 픽셀 단위 기본 연산 (화면: 프레임버퍼, 스프라이트: 자기 버퍼)
+  virtual void drawPixel(int32_t x, int32_t y, uint32_t color);
+  virtual uint16_t readPixel(int32_t x, int32_t y);
+
+  void fillScreen(uint32_t color);
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+  void fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+  void drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+  void fillEllipse(int16_t x0, int16_t y0, int32_t rx, int32_t ry, uint16_t color);
+  void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color);
+  void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t fg);
+  void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t fg, uint16_t bg);
+
+  void setFreeFont(const GFXfont* f) { gfxFont = f; }
+  void setTextFont(uint8_t) { gfxFont = nullptr; }
+  void setTextSize(uint8_t s) { textsize = s ? s : 1; }
+  void setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+  void setTextColor(uint16_t c, uint16_t bg, bool = false) { textcolor = c; textbgcolor = bg; }
+  void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+  void setTextDatum(uint8_t d) { textdatum = d; }
+  void setTextWrap(bool wrapX) { textwrapX = wrapX; }
+  int16_t getCursorX() const { return cursor_x; }
+  int16_t getCursorY() const { return cursor_y; }
+
+  size_t write(uint8_t c);
+  size_t print(const char* s);
+  size_t print(const String& s) { return print(s.c_str()); }
+  size_t print(int v) { return print(String(v)); }
+  int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+  int16_t drawString(const char* s, int32_t x, int32_t y);
+  int16_t drawString(const String& s, int32_t x, int32_t y) { return drawString(s.c_str(), x, y); }
+  int16_t drawChar(uint16_t c, int32_t x, int32_t y);
+  int16_t textWidth(const char* s);
+  int16_t textWidth(const String& s) { return textWidth(s.c_str()); }
+  int16_t fontHeight();
+
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data);
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data, uint16_t* = nullptr);
+  bool initDMA(bool = false);                           // hostDma = false 이면 실패 -> 그래프는 pushSprite 경로
+  void deInitDMA();
+  bool dmaBusy() { return _dmaBusy; }
+  void dmaWait();
+  void startWrite() { _inTransaction = true; }
+  void endWrite();
+  void setSwapBytes(bool s) { _swapBytes = s; }
+  bool getSwapBytes() const { return _swapBytes; }
+  uint16_t color565(uint8_t r, uint8_t g, uint8_t b) { return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3); }
+
+  // 호스트 전용: 화면에 찍힌 픽셀 수 (벤치 출력용)
+  std::atomic<uint64_t> hostPixelWrites{0};
+  // 호스트 전용 DMA 설정/통계
+  bool hostDma = true;                                  // initDMA() 결과
+  uint32_t hostDmaNsPerPixel = 600;                     // 27MHz SPI, 픽셀당 16비트
+  std::atomic<uint32_t> hostDmaTransfers{0};
+  std::atomic<uint32_t> hostDmaErrors{0};               // 전송 중 화면 읽기/쓰기, startWrite 밖 전송, 전송 중 endWrite
+
+protected:
+  void fbWrite(int32_t x, int32_t y, uint16_t color);  // 회전 적용, 검사 없음 (DMA 작업 스레드도 사용)
+  void drawGlcdChar(int32_t x, int32_t y, uint8_t c, uint16_t fg, uint16_t bg, uint8_t size);
+  void drawGfxChar(int32_t x, int32_t y, uint8_t c, uint16_t fg, uint8_t size);
+  int16_t charAdvance(uint8_t c);
+
+  int16_t _init_width, _init_height;                    // 패널 (회전 0 기준)
+  int16_t _width, _height;                              // 현재 회전 기준
+  uint8_t rotation = 0;
+  std::vector<uint16_t> fb;                             // 패널 좌표 RGB565
+
+  int32_t cursor_x = 0, cursor_y = 0;
+  uint16_t textcolor = TFT_WHITE, textbgcolor = TFT_WHITE;
+  uint8_t textsize = 1, textdatum = TL_DATUM;
+  bool textwrapX = true;
+  const GFXfont* gfxFont = nullptr;
+  bool _swapBytes = false;
+
+  struct HostDma;
+  HostDma* _dma = nullptr;
+  std::atomic<bool> _dmaBusy{false};
+  bool _inTransaction = false;
+};
+
+class TFT_eSprite : public TFT_eSPI {
+public:
+  explicit TFT_eSprite(TFT_eSPI* tft);
+  ~TFT_eSprite() override { deleteSprite(); }
+
+  void* createSprite(int16_t w, int16_t h, uint8_t frames = 1);
+  void deleteSprite();
+  bool created() const { return _img != nullptr; }
+  void* setColorDepth(int8_t b);
+  int8_t getColorDepth() const { return _bpp; }
+  void* getPointer() { return _img; }
+
+  void drawPixel(int32_t x, int32_t y, uint32_t color) override;
+  uint16_t readPixel(int32_t x, int32_t y) override;
+  uint16_t readPixelValue(int32_t x, int32_t y);
+
+  void fillSprite(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+  void pushSprite(int32_t x, int32_t y);
+  void pushSprite(int32_t x, int32_t y, uint16_t transparent);
+  void setScrollRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color = TFT_BLACK);
+  void scroll(int16_t dx, int16_t dy = 0);
+  void createPalette(const uint16_t* colors, uint8_t n = 16);
+  void setPaletteColor(uint8_t i, uint16_t c) { if (i < 16) _palette[i] = c; }
+  uint16_t getPaletteColor(uint8_t i) { return _palette[i & 0x0F]; }
+  void setBitmapColor(uint16_t fg, uint16_t bg) { _bitmap_fg = fg; _bitmap_bg = bg; }
+
+private:
+  void pushSpriteImpl(int32_t x, int32_t y, bool useTransparent, uint16_t transparent);
+
+  TFT_eSPI* _tft;
+  uint8_t* _img = nullptr;
+  int8_t _bpp = 16;
+  int32_t _rowBytes = 0;                                // 1비트 전용 (줄 단위 정렬)
+  size_t _heapBytes = 0;                                // hostHeapUsed 에 더한 양
+  uint16_t _palette[16] = { 0 };
+  uint16_t _bitmap_fg = TFT_WHITE, _bitmap_bg = TFT_BLACK;
+  int32_t _sx = 0, _sy = 0, _sw = 0, _sh = 0;
+  uint16_t _scolor = TFT_BLACK;
+};
@@ -0,0 +1,32 @@
+// 호스트 빌드용 Update(OTA) 대체: 받은 이미지를 메모리에 모으고 end() 에서 ESP 이미지 매직 바이트와 MD5 를 검증
+#pragma once
+#include <Arduino.h>
+#include <vector>
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+#define U_FLASH 0
+class UpdateClass {
+public:
+  bool begin(size_t size = UPDATE_SIZE_UNKNOWN, int command = U_FLASH);
+  size_t write(uint8_t* data, size_t len);
+  bool end(bool evenIfRemaining = false);
+  void abort();
+  bool setMD5(const char* expectedMd5);
+  bool isRunning() { return _running; }
+  bool hasError() { return _error[0] != '\0'; }
+  const char* errorString() { return _error; }
+  size_t progress() { return hostImage.size(); }
+
+  // 호스트 테스트용
+  std::vector<uint8_t> hostImage;                    // 지금까지 받은 바이트
+  bool hostCommitted = false;                        // end() 가 성공해 다음 부팅 파티션으로 지정됨
+  uint32_t hostBegins = 0, hostAborts = 0;
+  size_t hostFailWriteAt = 0;                        // 0 이 아니면 이 바이트 수를 넘는 write() 는 실패 (플래시 오류)
+
+private:
+  bool _running = false;
+  char _md5[33] = "";
+  char _error[48] = "";
+};
+extern UpdateClass Update;
+
+void hostMd5Hex(const uint8_t* data, size_t len, char out[33]);
@@ -0,0 +1,51 @@
+// 호스트 빌드용 WebServer 대체 (요청을 받지 않음, 응답은 상태 코드와 본문만 기록)
+// 테스트는 hostArgs / hostAuthorized / hostUpload 를 채우고 핸들러를 직접 부름
+#pragma once
+#include <WiFi.h>
+#include <map>
+#include <string>
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_POST };
+enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END, UPLOAD_FILE_ABORTED };
+struct HTTPUpload { HTTPUploadStatus status; String filename; String name; String type; size_t totalSize; size_t currentSize; uint8_t buf[1436]; };
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+class WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+  WebServer(int) {}
+  void on(const String&, HTTPMethod, THandlerFunction) {}
+  void on(const String&, HTTPMethod, THandlerFunction, THandlerFunction) {}
+  void on(const String&, THandlerFunction) {}
+  void onNotFound(THandlerFunction) {}
+  void begin() {}
+  void handleClient() {}
+  bool hasArg(const String& name) { return hostArgs.count(name.c_str()) != 0; }
+  String arg(const String& name) { auto it = hostArgs.find(name.c_str()); return it == hostArgs.end() ? String() : String(it->second.c_str()); }
+  String uri() { return String(); }
+  HTTPMethod method() { return HTTP_GET; }
+  String header(const String&) { return String(); }
+  bool hasHeader(const String&) { return false; }
+  void collectHeaders(const char*[], size_t) {}
+  void sendHeader(const String&, const String&, bool = false) {}
+  void setContentLength(size_t) {}
+  void send(int code, const char*, const String& body) { hostStatus = code; hostBody = body; hostContent.clear(); }
+  void send(int code, const String&, const String& body) { hostStatus = code; hostBody = body; hostContent.clear(); }
+  void send(int code, const char* = nullptr) { hostStatus = code; hostBody = String(); }
+  void send_P(int code, PGM_P, PGM_P) { hostStatus = code; hostBody = String(); }
+  void send_P(int code, PGM_P, PGM_P, size_t) { hostStatus = code; hostBody = String(); }
+  void sendContent(const String& s) { hostContent.append(s.c_str(), s.length()); }
+  void sendContent(const char* p, size_t n) { hostContent.append(p, n); }
+  void sendContent_P(PGM_P) {}
+  void sendContent_P(PGM_P, size_t) {}
+  bool authenticate(const char*, const char*) { return hostAuthorized; }
+  void requestAuthentication() { hostStatus = 401; }
+  HTTPUpload& upload() { return hostUpload; }
+  WiFiClient client() { return WiFiClient(); }
+
+  // 호스트 테스트용
+  std::map<std::string, std::string> hostArgs;
+  bool hostAuthorized = false;
+  int hostStatus = 0;                                 // 마지막 응답 코드
+  String hostBody;
+  std::string hostContent;                          // send() 뒤 sendContent() 로 보낸 바이트
+  HTTPUpload hostUpload = {};
+};
@@ -0,0 +1,24 @@
+// 호스트 빌드용 WiFi 대체 (항상 연결 안 됨)
+#pragma once
+#include <Arduino.h>
+#define WL_CONNECTED 3
+#define WIFI_AP_STA 3
+class WiFiClient {
+public:
+  size_t write(const uint8_t*, size_t n) { return n; }
+  bool connected() { return false; }
+  void stop() {}
+};
+struct WiFiClass {
+  int status() { return 0; }
+  void mode(int) {}
+  void softAP(const char*, const char*) {}
+  void softAPConfig(IPAddress, IPAddress, IPAddress) {}
+  String SSID() { return String(); }
+  IPAddress localIP() { return IPAddress(); }
+  IPAddress softAPIP() { return IPAddress(); }
+  void begin(const char*, const char*) {}
+  void disconnect() {}
+  int RSSI() { return 0; }
+};
+extern WiFiClass WiFi;
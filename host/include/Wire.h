@@ -0,0 +1,16 @@
+// 호스트 빌드용 Wire 대체 (I2C 장치 없음: 모든 전송 실패)
+#pragma once
+#include <Arduino.h>
+class TwoWire {
+public:
+  void begin(int, int) {}
+  void setTimeout(int) {}
+  void beginTransmission(uint8_t) {}
+  uint8_t endTransmission(bool = true) { return 2; }
+  size_t write(uint8_t) { return 1; }
+  uint8_t requestFrom(uint8_t, uint8_t) { return 0; }
+  int read() { return -1; }
+  int available() { return 0; }
+  void setClock(uint32_t) {}
+};
+extern TwoWire Wire;
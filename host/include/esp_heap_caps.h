@@ -0,0 +1,12 @@
+// 호스트 빌드용 heap_caps 대체 (일반 malloc)
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#define MALLOC_CAP_DMA (1<<3)
+#define MALLOC_CAP_8BIT (1<<2)
+#define MALLOC_CAP_INTERNAL (1<<11)
+inline void* heap_caps_malloc(size_t n, uint32_t) { return malloc(n); }
+inline void heap_caps_free(void* p) { free(p); }
+inline size_t heap_caps_get_free_size(uint32_t) { return 200000; }
+inline size_t heap_caps_get_largest_free_block(uint32_t) { return 100000; }
@@ -0,0 +1,10 @@
+// 호스트 빌드용 태스크 와치독 대체 (리셋 횟수만 셈)
+#pragma once
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+typedef int esp_err_t;
+inline esp_err_t esp_task_wdt_init(uint32_t, bool) { return 0; }
+inline esp_err_t esp_task_wdt_add(TaskHandle_t) { return 0; }
+extern uint32_t hostWdtResets;
+inline esp_err_t esp_task_wdt_reset() { hostWdtResets++; return 0; }
+inline esp_err_t esp_task_wdt_delete(TaskHandle_t) { return 0; }
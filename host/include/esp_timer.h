@@ -0,0 +1,11 @@
+// 호스트 빌드용 esp_timer 대체 (타이머는 만들어지지만 콜백은 호출되지 않음)
+#pragma once
+#include <cstdint>
+typedef int esp_err_t;
+typedef struct esp_timer* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void*);
+typedef enum { ESP_TIMER_TASK } esp_timer_dispatch_t;
+typedef struct { esp_timer_cb_t callback; void* arg; esp_timer_dispatch_t dispatch_method; const char* name; bool skip_unhandled_events; } esp_timer_create_args_t;
+inline esp_err_t esp_timer_create(const esp_timer_create_args_t*, esp_timer_handle_t* h) { *h = nullptr; return 0; }
+inline esp_err_t esp_timer_start_periodic(esp_timer_handle_t, uint64_t) { return 0; }
+int64_t esp_timer_get_time();
@@ -0,0 +1,9 @@
+// 호스트 빌드용 이벤트 그룹: 스레드 사이에서 실제로 기다리고 깨움 (mutex + condition_variable)
+#pragma once
+#include "FreeRTOS.h"
+typedef void* EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+EventGroupHandle_t xEventGroupCreate();
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clearOnExit, BaseType_t waitAll, TickType_t ticks);
@@ -0,0 +1,9 @@
+#pragma once
+#include "FreeRTOS.h"
+inline QueueHandle_t xQueueCreate(UBaseType_t, UBaseType_t) { return nullptr; }
+inline BaseType_t xQueueSend(QueueHandle_t, const void*, TickType_t) { return pdFALSE; }
+inline BaseType_t xQueueReceive(QueueHandle_t, void*, TickType_t) { return pdFALSE; }
+inline BaseType_t xQueueSendFromISR(QueueHandle_t, const void*, BaseType_t*) { return pdFALSE; }
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t) { return 0; }
+inline BaseType_t xQueueOverwrite(QueueHandle_t, const void*) { return pdFALSE; }
+inline void portYIELD_FROM_ISR(BaseType_t = 0) {}
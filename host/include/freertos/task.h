@@ -0,0 +1,13 @@
+#pragma once
+#include "FreeRTOS.h"
+inline BaseType_t xTaskCreatePinnedToCore(void (*)(void*), const char*, uint32_t, void*, UBaseType_t, TaskHandle_t*, BaseType_t) { return pdFALSE; }
+void vTaskDelay(TickType_t ticks);
+inline void vTaskDelayUntil(TickType_t*, TickType_t) {}
+inline TickType_t xTaskGetTickCount() { return 0; }
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 0; }
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+inline BaseType_t xPortGetCoreID() { return 1; }
+inline void taskYIELD() {}
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+inline BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdPASS; }
+inline void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t*) {}
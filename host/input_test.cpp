@@ -0,0 +1,91 @@
+// 호스트 엔코더 글리치 필터 테스트: encoderIsr() 에 CLK/DT 에지 열을 넣고 입력 타이머의 encCommitStable() 을 돌려
+// 접점 튐 (+1/-1 쌍) 이 이벤트로 나가지 않는지, 안정된 뒤에만 합계가 나가는지, 버린 에지가 encGlitches 에 세어지는지
+// 호스트 큐는 항상 가득 차 있으므로 보낸 단계는 encOverflowDelta 에 쌓임 (handleInputEvents 가 합치는 값)
+#include "../main_v25.cpp"
+
+static int failures = 0, checks = 0;
+
+static void check(bool ok, const char* what) {
+  checks++;
+  if (ok) { printf("ok   %s\n", what); return; }
+  printf("FAIL %s\n", what);
+  failures++;
+}
+
+// 2비트 상태 (CLK << 1 | DT) 를 핀에 놓고 인터럽트 한 번
+static void edge(uint8_t state) {
+  hostSetPin(ENCODER_CLK, (state >> 1) & 1);
+  hostSetPin(ENCODER_DT, state & 1);
+  encoderIsr();
+}
+
+static void edges(std::initializer_list<uint8_t> states) {
+  for (uint8_t st : states) edge(st);
+}
+
+static void settle() { delayMicroseconds(ENC_STABLE_US + 500); }
+
+static int32_t takeSent() {
+  int32_t d = encOverflowDelta;
+  encOverflowDelta = 0;
+  return d;
+}
+
+// 시계 방향 한 칸: 11 -> 10 -> 00 -> 01 -> 11 (전이마다 +1)
+static void testCleanDetent() {
+  uint32_t g0 = encGlitches, s0 = encSteps;
+  edges({ 2, 0, 1, 3 });
+  settle();
+  encCommitStable();
+  check(takeSent() == 4 && encSteps - s0 == 4 && encGlitches == g0, "clean detent: +4, no glitches");
+}
+
+static void testBounceNotSentBeforeStable() {
+  edges({ 2, 3, 2, 3, 2 });                                     // 첫 에지에서 튐
+  encCommitStable();                                            // 아직 안정되지 않음
+  check(takeSent() == 0, "bounce: nothing sent while edges are still arriving");
+  edges({ 0, 1, 3 });
+  settle();
+  encCommitStable();
+  uint32_t g0 = encGlitches;
+  check(takeSent() == 4, "bounce: net +4 once stable");
+  encCommitStable();
+  check(takeSent() == 0 && encGlitches == g0, "bounce: sent once");
+}
+
+static void testBounceCounted() {
+  uint32_t g0 = encGlitches;
+  edges({ 2, 3, 2, 3, 2, 3 });                                  // 튀기만 하고 제자리
+  settle();
+  encCommitStable();
+  check(takeSent() == 0, "pure bounce: no +1/-1 pair reaches the queue");
+  check(encGlitches - g0 == 6, "pure bounce: 6 cancelled edges counted as glitches");
+}
+
+static void testCounterClockwise() {
+  uint32_t g0 = encGlitches;
+  edges({ 1, 0, 2, 3, 1, 0, 2, 3 });                            // 반시계 두 칸
+  settle();
+  encCommitStable();
+  check(takeSent() == -8 && encGlitches == g0, "counter-clockwise: -8");
+}
+
+static void testDoubleBitChange() {
+  uint32_t g0 = encGlitches;
+  edges({ 0, 3 });                                              // 11 -> 00 -> 11: 방향을 알 수 없음
+  settle();
+  encCommitStable();
+  check(takeSent() == 0 && encGlitches - g0 == 2, "both bits changed: no step, 2 glitches");
+}
+
+int main() {
+  edge(3);                                                      // startInputIsr 처럼 11 에서 시작
+  lastEncState = 3;
+  testCleanDetent();
+  testBounceNotSentBeforeStable();
+  testBounceCounted();
+  testCounterClockwise();
+  testDoubleBitChange();
+  printf("%d/%d checks pass\n", checks - failures, checks);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+// 호스트 MetricsWriter 테스트: 버퍼 (512바이트) 경계 근처와 버퍼보다 긴 줄이 빠짐없이 순서대로 나가는지,
+// /debug/http 처럼 긴 서식 문자열로 시작하는 페이지와 /metrics 의 cage_metrics_truncated_total
+#include "../main_v25.cpp"
+
+static int failures = 0, checks = 0;
+
+static void check(bool ok, const char* what) {
+  checks++;
+  if (ok) { printf("ok   %s\n", what); return; }
+  printf("FAIL %s\n", what);
+  failures++;
+}
+
+static std::string line(size_t len, char c) {
+  std::string s(len, c);
+  if (len) s.back() = '\n';
+  return s;
+}
+
+// 길이 목록대로 printf 하고 받은 바이트가 이어 붙인 것과 같은지
+static void testLengths(std::initializer_list<size_t> lens, const char* what) {
+  server.send(200, "text/plain", "");
+  std::string want;
+  MetricsWriter w;
+  char c = 'a';
+  for (size_t len : lens) {
+    std::string s = line(len, c);
+    c = c == 'z' ? 'a' : c + 1;
+    w.printf("%s", s.c_str());
+    want += s;
+  }
+  w.flush();
+  uint32_t t0 = metricsTruncated;
+  check(server.hostContent == want && metricsTruncated == t0, what);
+}
+
+static void testWriter() {
+  testLengths({ 10, 20, 30 }, "writer: short lines");
+  testLengths({ 500, 11, 1 }, "writer: fills the buffer to 511 bytes");
+  testLengths({ 500, 12, 5 }, "writer: line that just overflows goes to the next buffer");
+  testLengths({ 511 }, "writer: 511-byte line");
+  testLengths({ 512 }, "writer: 512-byte line (longer than the buffer can hold)");
+  testLengths({ 100, 2000, 100 }, "writer: 2000-byte line between short lines, in order");
+  testLengths({ 5000, 5000 }, "writer: two long lines back to back");
+
+  server.send(200, "text/plain", "");
+  MetricsWriter w;
+  w.printf("n=%d %s %.1f\n", 42, std::string(700, 'x').c_str(), 1.5);
+  w.flush();
+  check(server.hostContent == "n=42 " + std::string(700, 'x') + " 1.5\n", "writer: long formatted line keeps its arguments");
+}
+
+static void testDebugHttp() {
+  handleDebugHttp();
+  const std::string &b = server.hostContent;
+  check(b.compare(0, 15, "<!DOCTYPE html>") == 0 && b.find("</html>") != std::string::npos, "/debug/http: page header and footer present");
+}
+
+static void testMetrics() {
+  handleMetrics();
+  const std::string &b = server.hostContent;
+  check(b.find("\ncage_metrics_truncated_total 0\n") != std::string::npos, "/metrics: cage_metrics_truncated_total 0");
+  check(b.find("cage_temperature_celsius ") != std::string::npos && b.find("cage_http_handler_seconds") != std::string::npos,
+        "/metrics: first and last families present");
+}
+
+int main() {
+  testWriter();
+  testDebugHttp();
+  testMetrics();
+  printf("%d/%d checks pass\n", checks - failures, checks);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,170 @@
+// 호스트 OTA 업로드 테스트: handleOtaUpload() 에 multipart 업로드처럼 START / WRITE(1436바이트 청크) / END 를 넣고
+// handleOtaFinish() 의 응답과 재부팅 여부를 확인 (Update 는 host/update_host.cpp 가 메모리에 받아 end() 에서 MD5 검증)
+//   MD5 없는 업로드는 Update.begin 전에 거부, MD5 가 틀리거나 잘린 이미지는 500 + 재부팅 안 함
+//   청크 사이마다 serviceControlDuringOta() 가 돌아 loop 태스크 와치독이 리셋되는지
+#include "../main_v25.cpp"
+
+static int failures = 0, checks = 0;
+
+static void check(bool ok, const char* what) {
+  checks++;
+  if (ok) { printf("ok   %s\n", what); return; }
+  printf("FAIL %s\n", what);
+  failures++;
+}
+
+static const size_t CHUNK = sizeof(HTTPUpload::buf);
+
+// ESP 이미지처럼 0xE9 로 시작하는 가짜 펌웨어
+static std::vector<uint8_t> makeImage(size_t len) {
+  std::vector<uint8_t> img(len);
+  for (size_t i = 0; i < len; i++) img[i] = (uint8_t)(i * 31 + (i >> 8));
+  img[0] = 0xE9;
+  return img;
+}
+
+static std::string md5Of(const std::vector<uint8_t> &data) {
+  char hex[33];
+  hostMd5Hex(data.data(), data.size(), hex);
+  return hex;
+}
+
+static void uploadStatus(HTTPUploadStatus st, const uint8_t* data = nullptr, size_t len = 0) {
+  HTTPUpload &u = server.hostUpload;
+  u.status = st;
+  u.currentSize = len;
+  if (len) memcpy(u.buf, data, len);
+  if (st == UPLOAD_FILE_WRITE) u.totalSize += len;
+  handleOtaUpload();
+}
+
+struct UploadResult {
+  int status;
+  uint32_t restarts;
+  uint32_t begins;
+  uint32_t wdtResets;
+  size_t chunks;
+};
+
+// sendBytes 만큼 청크로 보낸 뒤 END (aborted 면 ABORTED), 그리고 /update 응답
+static UploadResult upload(const std::vector<uint8_t> &img, const char* md5, size_t sendBytes, bool aborted = false) {
+  server.hostArgs.clear();
+  if (md5) server.hostArgs["md5"] = md5;
+  server.hostAuthorized = true;
+  server.hostStatus = 0;
+  server.hostUpload = {};
+  server.hostUpload.filename = "firmware.bin";
+  uint32_t restarts0 = hostRestarts, begins0 = Update.hostBegins, wdt0 = hostWdtResets;
+
+  UploadResult r = {};
+  uploadStatus(UPLOAD_FILE_START);
+  for (size_t off = 0; off < sendBytes; off += CHUNK) {
+    uploadStatus(UPLOAD_FILE_WRITE, img.data() + off, std::min(CHUNK, sendBytes - off));
+    r.chunks++;
+  }
+  uploadStatus(aborted ? UPLOAD_FILE_ABORTED : UPLOAD_FILE_END);
+  handleOtaFinish();
+
+  r.status = server.hostStatus;
+  r.restarts = hostRestarts - restarts0;
+  r.begins = Update.hostBegins - begins0;
+  r.wdtResets = hostWdtResets - wdt0;
+  return r;
+}
+
+static void testGoodImage() {
+  std::vector<uint8_t> img = makeImage(300 * 1024 + 123);       // 마지막 청크는 덜 참
+  UploadResult r = upload(img, md5Of(img).c_str(), img.size());
+  check(r.status == 200 && r.restarts == 1, "good image: 200 and restart");
+  check(Update.hostCommitted && Update.hostImage == img, "good image: every chunk written in order and committed");
+  check(otaWritten == img.size() && !otaInProgress, "good image: otaWritten == image size");
+}
+
+static void testUppercaseMd5() {
+  std::vector<uint8_t> img = makeImage(5000);
+  std::string md5 = md5Of(img);
+  for (char &c : md5) c = (char)toupper(c);
+  UploadResult r = upload(img, md5.c_str(), img.size());
+  check(r.status == 200 && r.restarts == 1, "upper-case md5: accepted");
+}
+
+static void testBadMd5() {
+  std::vector<uint8_t> img = makeImage(20000);
+  std::vector<uint8_t> other = img;
+  other[1000] ^= 1;
+  UploadResult r = upload(img, md5Of(other).c_str(), img.size());
+  check(r.status == 500 && r.restarts == 0 && !Update.hostCommitted, "bad md5: 500, not committed, no restart");
+  check(strstr(otaError, "MD5") != nullptr, "bad md5: error names the MD5 check");
+}
+
+static void testMissingMd5() {
+  std::vector<uint8_t> img = makeImage(20000);
+  static const char* BAD[] = { nullptr, "", "0123456789abcdef", "0123456789abcdef0123456789abcdeg" };
+  for (const char* md5 : BAD) {
+    UploadResult r = upload(img, md5, img.size());
+    char what[96];
+    snprintf(what, sizeof(what), "md5 '%s': rejected before Update.begin, 500", md5 ? md5 : "(none)");
+    check(r.begins == 0 && r.status == 500 && r.restarts == 0 && otaWritten == 0, what);
+  }
+}
+
+static void testTruncated() {
+  std::vector<uint8_t> img = makeImage(50000);
+  std::string md5 = md5Of(img);
+
+  UploadResult r = upload(img, md5.c_str(), img.size() / 2, true);
+  check(r.status == 500 && r.restarts == 0 && Update.hostAborts > 0 && !Update.isRunning(),
+        "aborted upload: Update aborted, 500, no restart");
+
+  r = upload(img, md5.c_str(), img.size() - 1000);              // 연결은 정상 종료, 데이터는 모자람
+  check(r.status == 500 && r.restarts == 0 && !Update.hostCommitted, "truncated upload: md5 mismatch, 500, no restart");
+}
+
+static void testFlashWriteError() {
+  std::vector<uint8_t> img = makeImage(20000);
+  Update.hostFailWriteAt = 8000;
+  UploadResult r = upload(img, md5Of(img).c_str(), img.size());
+  Update.hostFailWriteAt = 0;
+  check(r.status == 500 && r.restarts == 0 && otaWritten < 8000, "flash write error: rest of upload ignored, 500");
+}
+
+static void testUnauthorized() {
+  std::vector<uint8_t> img = makeImage(5000);
+  server.hostAuthorized = false;
+  server.hostArgs.clear();
+  server.hostArgs["md5"] = md5Of(img);
+  server.hostUpload = {};
+  uint32_t begins0 = Update.hostBegins;
+  uploadStatus(UPLOAD_FILE_START);
+  uploadStatus(UPLOAD_FILE_WRITE, img.data(), CHUNK);
+  uploadStatus(UPLOAD_FILE_END);
+  handleOtaFinish();
+  check(server.hostStatus == 401 && Update.hostBegins == begins0, "unauthorized: 401, Update not started");
+}
+
+// 업로드 동안 loop 태스크는 handleClient 에 묶여 있으므로 청크마다 와치독을 리셋해야 함
+static void testWatchdogBetweenChunks() {
+  std::vector<uint8_t> img = makeImage(100 * CHUNK + 7);
+  UploadResult r = upload(img, md5Of(img).c_str(), img.size());
+  char what[96];
+  snprintf(what, sizeof(what), "watchdog: reset once per chunk (%u resets, %u chunks)", (unsigned)r.wdtResets, (unsigned)r.chunks);
+  check(r.status == 200 && r.wdtResets == r.chunks, what);
+}
+
+int main() {
+  // RFC 1321 예제로 호스트 MD5 확인
+  char hex[33];
+  hostMd5Hex((const uint8_t*)"abc", 3, hex);
+  check(strcmp(hex, "900150983cd24fb0d6963f7d28e17f72") == 0, "host md5: RFC 1321 'abc'");
+
+  testGoodImage();
+  testUppercaseMd5();
+  testBadMd5();
+  testMissingMd5();
+  testTruncated();
+  testFlashWriteError();
+  testUnauthorized();
+  testWatchdogBetweenChunks();
+  printf("%d/%d checks pass\n", checks - failures, checks);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,114 @@
+// 호스트 빌드용 PNG 읽기/쓰기 (8비트 RGB, zlib)
+#include "png_io.h"
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <zlib.h>
+
+static const uint8_t PNG_SIG[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+static void put32(std::vector<uint8_t>& out, uint32_t v) {
+  for (int i = 3; i >= 0; i--) out.push_back((v >> (8 * i)) & 0xFF);
+}
+
+static uint32_t get32(const uint8_t* p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void putChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+  put32(out, (uint32_t)data.size());
+  size_t start = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  put32(out, (uint32_t)crc32(0, out.data() + start, (uInt)(out.size() - start)));
+}
+
+bool pngWrite(const std::string& path, const RgbImage& img) {
+  std::vector<uint8_t> raw;                                    // 줄마다 필터 0 + RGB
+  raw.reserve((size_t)(img.w * 3 + 1) * img.h);
+  for (int y = 0; y < img.h; y++) {
+    raw.push_back(0);
+    raw.insert(raw.end(), img.rgb.begin() + (size_t)y * img.w * 3, img.rgb.begin() + (size_t)(y + 1) * img.w * 3);
+  }
+  uLongf zlen = compressBound((uLong)raw.size());
+  std::vector<uint8_t> z(zlen);
+  if (compress2(z.data(), &zlen, raw.data(), (uLong)raw.size(), 9) != Z_OK) return false;
+  z.resize(zlen);
+
+  std::vector<uint8_t> ihdr;
+  put32(ihdr, img.w);
+  put32(ihdr, img.h);
+  ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 });                  // 8비트, RGB, deflate, 필터 0, 비인터레이스
+
+  std::vector<uint8_t> out(PNG_SIG, PNG_SIG + 8);
+  putChunk(out, "IHDR", ihdr);
+  putChunk(out, "IDAT", z);
+  putChunk(out, "IEND", {});
+
+  FILE* f = fopen(path.c_str(), "wb");
+  if (!f) return false;
+  bool ok = fwrite(out.data(), 1, out.size(), f) == out.size();
+  return fclose(f) == 0 && ok;
+}
+
+static uint8_t paeth(int a, int b, int c) {
+  int p = a + b - c, pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+  return (uint8_t)((pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c));
+}
+
+bool pngRead(const std::string& path, RgbImage& img) {
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  std::vector<uint8_t> buf;
+  uint8_t tmp[4096];
+  size_t n;
+  while ((n = fread(tmp, 1, sizeof(tmp), f)) > 0) buf.insert(buf.end(), tmp, tmp + n);
+  fclose(f);
+  if (buf.size() < 8 || memcmp(buf.data(), PNG_SIG, 8) != 0) return false;
+
+  std::vector<uint8_t> z;
+  size_t p = 8;
+  img.w = img.h = 0;
+  while (p + 12 <= buf.size()) {
+    uint32_t len = get32(&buf[p]);
+    if (p + 12 + len > buf.size()) return false;
+    const uint8_t* type = &buf[p + 4];
+    const uint8_t* data = &buf[p + 8];
+    if (!memcmp(type, "IHDR", 4)) {
+      if (len < 13 || data[8] != 8 || data[9] != 2 || data[12] != 0) return false;
+      img.w = (int)get32(data);
+      img.h = (int)get32(data + 4);
+    } else if (!memcmp(type, "IDAT", 4)) {
+      z.insert(z.end(), data, data + len);
+    } else if (!memcmp(type, "IEND", 4)) {
+      break;
+    }
+    p += 12 + len;
+  }
+  if (img.w <= 0 || img.h <= 0) return false;
+
+  size_t stride = (size_t)img.w * 3;
+  std::vector<uint8_t> raw((stride + 1) * img.h);
+  uLongf rawLen = (uLongf)raw.size();
+  if (uncompress(raw.data(), &rawLen, z.data(), (uLong)z.size()) != Z_OK || rawLen != raw.size()) return false;
+
+  img.rgb.assign(stride * img.h, 0);
+  for (int y = 0; y < img.h; y++) {
+    uint8_t filter = raw[y * (stride + 1)];
+    const uint8_t* src = &raw[y * (stride + 1) + 1];
+    uint8_t* dst = &img.rgb[y * stride];
+    const uint8_t* up = y ? &img.rgb[(y - 1) * stride] : nullptr;
+    for (size_t i = 0; i < stride; i++) {
+      int a = i >= 3 ? dst[i - 3] : 0, b = up ? up[i] : 0, c = (up && i >= 3) ? up[i - 3] : 0;
+      switch (filter) {
+        case 0: dst[i] = src[i]; break;
+        case 1: dst[i] = (uint8_t)(src[i] + a); break;
+        case 2: dst[i] = (uint8_t)(src[i] + b); break;
+        case 3: dst[i] = (uint8_t)(src[i] + ((a + b) >> 1)); break;
+        case 4: dst[i] = (uint8_t)(src[i] + paeth(a, b, c)); break;
+        default: return false;
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,13 @@
+// 호스트 빌드용 PNG 읽기/쓰기 (8비트 RGB, zlib)
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct RgbImage {
+  int w = 0, h = 0;
+  std::vector<uint8_t> rgb;                     // w * h * 3
+};
+
+bool pngWrite(const std::string& path, const RgbImage& img);
+bool pngRead(const std::string& path, RgbImage& img);        // 8비트 RGB, 비인터레이스만
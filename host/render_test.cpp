@@ -0,0 +1,376 @@
+// 호스트 렌더링 회귀 테스트 / 벤치 (하드웨어 없이 TFT 화면 확인)
+// 펌웨어 소스를 그대로 포함해 호스트 TFT_eSPI (RGB565 프레임버퍼) 로 그리고, 화면을 PNG 로 저장해 golden/ 과 비교
+//   render_test                 골든 이미지와 비교 (다르면 실패, out/<이름>.png 와 <이름>.diff.png 남김)
+//   render_test --update        골든 이미지 다시 만들기 (그림이 의도대로 바뀐 경우)
+//   render_test --bench [N]     요소별 그리기 시간 (호스트 CPU 기준, 가로/세로)
+//   render_test --no-dma        그래프를 DMA 스트립 경로 대신 pushSprite 대체 경로로 (initDMA 실패와 같음)
+// 기본은 DMA 경로: 호스트 TFT 의 pushImageDMA 는 작업 스레드가 전송 시간만큼 늦게 프레임버퍼에 씀
+#include "../main_v25.cpp"
+#include "png_io.h"
+#include <chrono>
+#include <sys/stat.h>
+
+#ifndef GOLDEN_DIR
+#define GOLDEN_DIR "golden"
+#endif
+
+static const time_t TEST_EPOCH = 1767258000;                 // 2026-01-01 18:00 KST (고정 시각)
+
+// 24시간 합성 데이터: 온도 26~30도, 습도 50~70% 삼각파, 30분 전에 5분 공백, 액추에이터는 온습도에 따라
+static void seedDisplayBuffer() {
+  initDisplayBuffer();
+  for (int i = 0; i < DISPLAY_MAX_SAMPLES; i++) {
+    LogRecord &rec = displayLogBuf[i];
+    int back = DISPLAY_MAX_SAMPLES - 1 - i;                     // 마지막 샘플로부터 몇 샘플 전
+    rec.ts = (uint32_t)(TEST_EPOCH - (time_t)back * GRAPH_SAMPLE_INTERVAL_SEC);
+    int tPhase = i % 600, hPhase = (i + 150) % 420;
+    int16_t t10 = 260 + (tPhase < 300 ? tPhase : 600 - tPhase) * 40 / 300;
+    int16_t h10 = 500 + (hPhase < 210 ? hPhase : 420 - hPhase) * 200 / 210;
+    uint8_t act = (t10 < 270 ? ACT_HEATER : 0) | (h10 < 550 ? ACT_HUMIDIFIER : 0) | (t10 > 295 ? ACT_FAN : 0);
+    if (back >= 150 && back < 175) { t10 = INVALID_VALUE; h10 = INVALID_VALUE; act = 0; }
+    rec.temp = t10;
+    rec.humi_act = packHumi(h10, act);
+  }
+  displayLogIndex = 0;
+  isDisplayBufferFull = true;
+}
+
+static void setGraphMode(int mode) {
+  displayHoursIndex = mode;
+  updateGraphTimeScale();
+}
+
+// 보이는 영역(가상 여백 TFT_WIDTH_OFFSET 제외)을 RGB888 로
+static RgbImage captureScreen() {
+  RgbImage img;
+  img.w = tft.width() - TFT_WIDTH_OFFSET;
+  img.h = tft.height() - TFT_WIDTH_OFFSET;
+  img.rgb.resize((size_t)img.w * img.h * 3);
+  for (int y = 0; y < img.h; y++) {
+    for (int x = 0; x < img.w; x++) {
+      uint16_t c = tft.readPixel(x, y);
+      uint8_t* p = &img.rgb[((size_t)y * img.w + x) * 3];
+      uint8_t r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+      p[0] = (r << 3) | (r >> 2);
+      p[1] = (g << 2) | (g >> 4);
+      p[2] = (b << 3) | (b >> 2);
+    }
+  }
+  return img;
+}
+
+// 차이 이미지: 같은 픽셀은 어둡게, 다른 픽셀은 마젠타
+static RgbImage diffImage(const RgbImage &a, const RgbImage &b, long &count, int box[4]) {
+  RgbImage d = a;
+  count = 0;
+  box[0] = a.w; box[1] = a.h; box[2] = -1; box[3] = -1;
+  for (int y = 0; y < a.h; y++) {
+    for (int x = 0; x < a.w; x++) {
+      size_t i = ((size_t)y * a.w + x) * 3;
+      uint8_t* p = &d.rgb[i];
+      if (memcmp(&a.rgb[i], &b.rgb[i], 3) == 0) { p[0] /= 4; p[1] /= 4; p[2] /= 4; continue; }
+      p[0] = 255; p[1] = 0; p[2] = 255;
+      count++;
+      box[0] = min(box[0], x); box[1] = min(box[1], y);
+      box[2] = max(box[2], x); box[3] = max(box[3], y);
+    }
+  }
+  return d;
+}
+
+static bool updateMode = false;
+static int failures = 0, checks = 0;
+
+static void checkGolden(const char* name) {
+  RgbImage actual = captureScreen();
+  std::string golden = std::string(GOLDEN_DIR) + "/" + name + ".png";
+  std::string out = std::string("out/") + name;
+  pngWrite(out + ".png", actual);
+  checks++;
+
+  if (updateMode) {
+    if (!pngWrite(golden, actual)) { printf("FAIL %-16s cannot write %s\n", name, golden.c_str()); failures++; return; }
+    printf("UPDATE %-16s %dx%d\n", name, actual.w, actual.h);
+    return;
+  }
+
+  RgbImage expected;
+  if (!pngRead(golden, expected)) { printf("FAIL %-16s missing golden %s (run with --update)\n", name, golden.c_str()); failures++; return; }
+  if (expected.w != actual.w || expected.h != actual.h) {
+    printf("FAIL %-16s size %dx%d, golden %dx%d\n", name, actual.w, actual.h, expected.w, expected.h);
+    failures++;
+    return;
+  }
+  long count;
+  int box[4];
+  RgbImage diff = diffImage(actual, expected, count, box);
+  if (count == 0) { printf("ok   %-16s\n", name); return; }
+  pngWrite(out + ".diff.png", diff);
+  printf("FAIL %-16s %ld px differ in (%d,%d)-(%d,%d), see %s.diff.png\n", name, count, box[0], box[1], box[2], box[3], out.c_str());
+  failures++;
+}
+
+static void setRotation(int rot) {
+  screenRotation = rot;
+  applyScreenRotation();
+}
+
+// loop() 가 하듯 전송이 끝날 때까지 graphFlushPump() 를 돌림
+static void drainGraphFlush() {
+  while (graphFlush.active) graphFlushPump();
+}
+
+// ---------- 화면 요소 ----------
+static void renderGraph(int mode) {
+  setGraphMode(mode);
+  tft.fillScreen(BG_COLOR);
+  drawGraphFrame();
+  drawGraph();
+  drainGraphFlush();
+}
+
+static void renderFace(float t, float h) {
+  publishState(t, h, 0);
+  tft.fillScreen(BG_COLOR);
+  invalidateWidget(W_FACE);
+  drawConditionFace();
+}
+
+static void renderIcons() {
+  publishState(27.5f, 50.0f, ACT_HEATER | ACT_FAN);
+  brightnessStep[0] = 5;
+  humidifierMode = ON;
+  heaterMode = AUTO;
+  fanMode = OFF;
+  fan_frame = 0;
+  tft.fillScreen(BG_COLOR);
+  for (int id = W_ICON_LED; id <= W_ICON_FAN; id++) invalidateWidget(id);
+  drawStatusIcons();
+}
+
+// DMA 경로: drawGraph() 는 첫 스트립을 DMA 에 넘기고 바로 돌아오고,
+// 전송되는 동안 loop 의 다음 작업이 돌아야 함 (graphFlushPump 는 전송 중이면 바로 돌아옴)
+static void checkDmaOverlap(int rot) {
+  checks++;
+  invalidateGraph();
+  drawGraph();
+  bool inFlight = graphFlush.active && tft.dmaBusy();
+  uint32_t loops = 0, busyLoops = 0;
+  while (graphFlush.active) {
+    if (tft.dmaBusy()) busyLoops++;                           // 이 loop 는 전송을 기다리지 않고 다른 일을 함
+    graphFlushPump();
+    loops++;
+  }
+  bool ok = inFlight && busyLoops > 0 && uiStats.graphBlockUs < uiStats.graphFrameUs;
+  printf("%s dma_overlap_rot%d  in_flight=%d loops=%u busy_loops=%u block_us=%u frame_us=%u\n", ok ? "ok  " : "FAIL",
+         rot, inFlight ? 1 : 0, loops, busyLoops, uiStats.graphBlockUs, uiStats.graphFrameUs);
+  if (!ok) failures++;
+}
+
+// 4비트 팔레트 -> RGB565 짝 LUT (user-037): 모든 색 짝을 스프라이트에 깔고 prepareGraphStrip() 결과를
+// 스프라이트가 보여 줄 색 (readPixel) 의 SPI 바이트 순서와 픽셀 단위로 비교 (짝수 x = 상위 니블, 바이트 스왑)
+static void checkStripLut(int rot) {
+  checks++;
+  const int w = layout->graph_w, h = layout->graph_h;
+  for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++) graphSprite.drawPixel(x, y, (x / NUM_GRAPH_COLORS + x + y) % NUM_GRAPH_COLORS);
+  drawGraphModeTag();
+
+  long bad = 0;
+  graphFlush.buf = 0;
+  for (graphFlush.nextRow = 0; graphFlush.nextRow < h; ) {
+    int row0 = graphFlush.nextRow;
+    prepareGraphStrip();
+    const uint16_t* strip = graphStripBuf[0];
+    for (int y = row0; y < graphFlush.nextRow; y++) {
+      for (int x = 0; x < w; x++) {
+        bool inTag = x >= GRAPH_TAG_X && x < GRAPH_TAG_X + graphTagSprite.width() && y >= GRAPH_TAG_Y && y < GRAPH_TAG_Y + graphTagSprite.height();
+        uint16_t c = inTag ? graphTagSprite.readPixel(x - GRAPH_TAG_X, y - GRAPH_TAG_Y) : graphSprite.readPixel(x, y);
+        if (strip[(y - row0) * w + x] != (uint16_t)((c >> 8) | (c << 8))) bad++;
+      }
+    }
+  }
+  graphFlush.nextRow = 0;
+  graphFlush.readyRows = 0;
+  invalidateGraph();
+  printf("%s strip_lut_rot%d    %ld px wrong\n", bad ? "FAIL" : "ok  ", rot, bad);
+  if (bad) failures++;
+}
+
+// 그래프 스프라이트가 실제로 차지한 힙과 16비트 대비 절약량 (createGraphSprite 가 힙 전후로 잰 값)
+static void checkSpriteHeap(int rot) {
+  checks++;
+  int32_t px = (int32_t)layout->graph_w * layout->graph_h;
+  int32_t expect = GRAPH_SPRITE_BPP == 4 ? px / 2 + 16 * 2 : px * 2;      // 4비트: 버퍼 + 팔레트 16색
+  bool ok = (int32_t)graphSpriteBytes == expect && graphSpriteReclaimedBytes == px * 2 - expect;
+  printf("%s sprite_heap_rot%d  %lu bytes, reclaimed %ld (expect %ld / %ld)\n", ok ? "ok  " : "FAIL", rot,
+         (unsigned long)graphSpriteBytes, (long)graphSpriteReclaimedBytes, (long)expect, (long)(px * 2 - expect));
+  if (!ok) failures++;
+}
+
+// 증분 스크롤 경로 (user-031): 샘플을 하나씩 넣으며 drawGraph() (scrollGraphLeft + 추가분만 그리기) 를 돌린 화면과
+// 같은 데이터로 전체 다시 그린 화면을 픽셀 단위로 비교. 중간에 센서 오류 (선 끊김) 와 액추에이터 변화 포함
+static void checkScrollMatchesFull(int rot, int mode, int samples) {
+  char name[32];
+  snprintf(name, sizeof(name), "scroll_%dh_rot%d", displayHoursOptions[mode], rot);
+  checks++;
+  renderGraph(mode);
+  uint32_t rescales0 = graphYRescales;
+  int scrolled = 0;
+  time_t now = TEST_EPOCH;
+  for (int i = 0; i < samples; i++) {
+    now += GRAPH_SAMPLE_INTERVAL_SEC;
+    hostSetEpoch(now);
+    int phase = (DISPLAY_MAX_SAMPLES + i) % 600, hPhase = (DISPLAY_MAX_SAMPLES + i + 150) % 420;   // seedDisplayBuffer 파형을 이어감
+    float t = (260 + (phase < 300 ? phase : 600 - phase) * 40 / 300) / 10.0f;
+    float h = (500 + (hPhase < 210 ? hPhase : 420 - hPhase) * 200 / 210) / 10.0f;
+    if (i % 60 >= 50) t = h = NAN;                             // 2분 센서 오류 (선 끊김)
+    pushToDisplayBuffer(t, h, (i / 7) % 3 == 0 ? ACT_HEATER : (i / 7) % 3 == 1 ? ACT_FAN : 0);
+    uint32_t right0 = graphScroll.rightCol, rescales = graphYRescales;
+    bool wasValid = graphScroll.valid;
+    drawGraph();
+    drainGraphFlush();
+    if (wasValid && graphYRescales == rescales && graphScroll.rightCol > right0) scrolled++;
+  }
+  RgbImage incremental = captureScreen();
+
+  invalidateGraph();
+  drawGraph();
+  drainGraphFlush();
+  RgbImage full = captureScreen();
+
+  long count;
+  int box[4];
+  RgbImage diff = diffImage(incremental, full, count, box);
+  bool ok = count == 0 && scrolled > 0;
+  printf("%s %-16s %d samples, %d scrolled draws, %u rescales, %ld px differ", ok ? "ok  " : "FAIL", name, samples, scrolled,
+         (unsigned)(graphYRescales - rescales0), count);
+  if (count) {
+    pngWrite(std::string("out/") + name + ".diff.png", diff);
+    printf(" in (%d,%d)-(%d,%d)", box[0], box[1], box[2], box[3]);
+  }
+  printf("\n");
+  if (!ok) failures++;
+
+  hostSetEpoch(TEST_EPOCH);                                     // 다음 검사는 원래 데이터로
+  seedDisplayBuffer();
+  rebuildGraphEnvelopes();
+  invalidateGraph();
+}
+
+// 전체 다시 그리기를 loop 여러 번에 나눠 그리기 (user-040): 예산 1us 로 매번 한 조각 (GRAPH_COMPOSE_SLICE_COLS 컬럼) 만
+// 정도만 그리고 멈춤 -> 다 그린 화면이 한 번에 그린 화면과 같은지, 중간 조각은 전송을 시작하지 않는지
+static void checkSlicedCompose(int rot, int mode) {
+  char name[32];
+  snprintf(name, sizeof(name), "sliced_%dh_rot%d", displayHoursOptions[mode], rot);
+  checks++;
+  renderGraph(mode);
+  RgbImage whole = captureScreen();
+
+  invalidateGraph();
+  int calls = 1, flushedEarly = 0;
+  while (!drawGraph(1)) {
+    if (graphFlush.active) flushedEarly++;
+    calls++;
+  }
+  drainGraphFlush();
+  RgbImage sliced = captureScreen();
+
+  long count;
+  int box[4];
+  RgbImage diff = diffImage(sliced, whole, count, box);
+  int maxCalls = (layout->graph_w + GRAPH_COMPOSE_SLICE_COLS - 1) / GRAPH_COMPOSE_SLICE_COLS;   // 1us 안에 끝난 조각은 이어서 그림
+  bool ok = count == 0 && calls > 1 && calls <= maxCalls && flushedEarly == 0;
+  printf("%s %-16s %d calls (max %d), %d early flushes, %ld px differ\n", ok ? "ok  " : "FAIL", name, calls, maxCalls, flushedEarly, count);
+  if (count) pngWrite(std::string("out/") + name + ".diff.png", diff);
+  if (!ok) failures++;
+}
+
+static void runGolden() {
+  char name[32];
+  for (int rot = 0; rot < 2; rot++) {
+    setRotation(rot);
+    checkSpriteHeap(rot);
+    if (graphStripBuf[0]) checkStripLut(rot);
+    for (int mode : { 0, 3 }) {
+      renderGraph(mode);
+      snprintf(name, sizeof(name), "graph_%dh_rot%d", displayHoursOptions[mode], rot);
+      checkGolden(name);
+    }
+    if (graphFlush.dma) checkDmaOverlap(rot);
+    for (int mode : { 0, 3 }) checkScrollMatchesFull(rot, mode, 300);
+    for (int mode : { 0, 3 }) checkSlicedCompose(rot, mode);
+    setGraphMode(0);
+
+    renderFace(27.5f, 50.0f);                                   // 정상: 노란 얼굴, 웃는 입
+    snprintf(name, sizeof(name), "face_good_rot%d", rot);
+    checkGolden(name);
+    renderFace(NAN, 75.0f);                                     // 센서 오류 + 습도 높음: 빨간 얼굴, 찡그린 입
+    snprintf(name, sizeof(name), "face_bad_rot%d", rot);
+    checkGolden(name);
+
+    renderIcons();
+    snprintf(name, sizeof(name), "icons_rot%d", rot);
+    checkGolden(name);
+  }
+  checks++;
+  if (tft.hostDmaErrors) {                                      // 전송 중 화면 접근 (tftSync 누락) 등
+    printf("FAIL dma_errors     %u (transfers %u)\n", (unsigned)tft.hostDmaErrors, (unsigned)tft.hostDmaTransfers);
+    failures++;
+  }
+  printf("%d/%d checks pass (dma=%d, %u transfers)\n", checks - failures, checks, graphFlush.dma ? 1 : 0, (unsigned)tft.hostDmaTransfers);
+}
+
+// ---------- 벤치 ----------
+static void runBench(int reps) {
+  printf("reps=%d sprite_bpp=%d dma=%d (graph: avg/max = loop() 를 막은 시간, 전송은 제외)\n", reps, GRAPH_SPRITE_BPP, graphFlush.dma ? 1 : 0);
+  printf("rot  element        avg_us   max_us     px/draw\n");
+  for (int rot = 0; rot < 2; rot++) {
+    setRotation(rot);
+    static const char* const names[] = { "graph_full", "graph_scroll", "face", "icons" };
+    for (int e = 0; e < 4; e++) {
+      uint64_t total = 0, maxUs = 0, pixels = 0;
+      for (int r = 0; r < reps; r++) {
+        switch (e) {
+          case 0: invalidateGraph(); break;
+          case 2: invalidateWidget(W_FACE); break;
+          case 3: for (int id = W_ICON_LED; id <= W_ICON_FAN; id++) invalidateWidget(id); break;
+        }
+        uint64_t px0 = tft.hostPixelWrites;
+        auto t0 = std::chrono::steady_clock::now();
+        switch (e) {
+          case 0: case 1: drawGraph(); break;
+          case 2: drawConditionFace(); break;
+          case 3: drawStatusIcons(); break;
+        }
+        uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+        if (e <= 1) { drainGraphFlush(); us = uiStats.graphBlockUs; }
+        total += us;
+        maxUs = max(maxUs, us);
+        pixels += tft.hostPixelWrites - px0;
+      }
+      printf("%3d  %-12s  %7lu  %7lu  %10lu\n", rot, names[e], (unsigned long)(total / reps), (unsigned long)maxUs, (unsigned long)(pixels / reps));
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  int benchReps = 0;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--update")) updateMode = true;
+    else if (!strcmp(argv[i], "--bench")) benchReps = (i + 1 < argc) ? atoi(argv[++i]) : 20;
+    else if (!strcmp(argv[i], "--no-dma")) tft.hostDma = false;
+    else { fprintf(stderr, "usage: %s [--update] [--bench [N]] [--no-dma]\n", argv[0]); return 2; }
+  }
+  mkdir("out", 0755);
+
+  hostSetEpoch(TEST_EPOCH);
+  timeSynced = true;
+  tft.init();
+  graphFlush.dma = tft.initDMA();                               // setup() 과 같이
+  seedDisplayBuffer();
+
+  if (benchReps > 0) { runBench(benchReps); return 0; }
+  runGolden();
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+// 호스트 스케줄러 테스트: schedDue / schedRun 이 millis() 한 바퀴 (0xFFFFFFFF -> 0) 를 넘어도
+// 주기 작업은 주기마다 한 번, 한 번짜리 작업은 마감에 한 번 실행되는지 (millis() 는 hostSetMillis 로 고정)
+#include "../main_v25.cpp"
+
+static int failures = 0, checks = 0;
+
+static void check(bool ok, const char* what) {
+  checks++;
+  if (ok) { printf("ok   %s\n", what); return; }
+  printf("FAIL %s\n", what);
+  failures++;
+}
+
+// 작업이 불릴 때의 millis() 기록
+static uint32_t runAt[2][64];
+static int runCount[2];
+static void record(int id) { if (runCount[id] < 64) runAt[id][runCount[id]] = millis(); runCount[id]++; }
+static void jobA() { record(0); }
+static void jobB() { record(1); }
+
+static SchedJob testJobs[2];
+static Scheduler testSched = { testJobs, 2, 0 };
+
+static void reset(uint32_t periodA, uint32_t periodB) {
+  testJobs[0] = { "a", jobA, periodA, 0, false, 0, 0 };
+  testJobs[1] = { "b", jobB, periodB, 0, false, 0, 0 };
+  runCount[0] = runCount[1] = 0;
+}
+
+static uint32_t runAtMs(uint32_t now) {
+  hostSetMillis(now);
+  return schedRun(testSched, now);
+}
+
+static void testDue() {
+  check(schedDue(0xFFFFFFF0u, 0xFFFFFFF0u), "due: same tick");
+  check(schedDue(0xFFFFFFF0u, 5), "due: deadline before wrap, now after");
+  check(!schedDue(5, 0xFFFFFFF0u), "due: deadline after wrap, now before");
+}
+
+// 주기 1000ms, 랩 4초 전에 시작해 10ms 단위로 랩 뒤 6초까지 진행
+static void testPeriodicAcrossWrap() {
+  reset(1000, 0);
+  uint32_t start = 0xFFFFFFFFu - 4000;
+  schedStart(testSched, start, 0);
+  for (uint32_t t = 0; t <= 10000; t += 10) runAtMs(start + t);
+
+  check(runCount[0] == 11, "periodic: 11 runs in 10 s");
+  bool evenlySpaced = true;
+  for (int i = 1; i < runCount[0] && i < 64; i++) evenlySpaced &= (runAt[0][i] - runAt[0][i - 1]) == 1000;
+  check(evenlySpaced, "periodic: exactly 1000 ms apart across the wrap");
+  check(testJobs[0].lateMaxMs == 0, "periodic: never late");
+}
+
+// 한 번짜리 작업: 랩 직전에 랩 뒤 마감으로 예약
+static void testOneShotAcrossWrap() {
+  reset(0, 0);
+  uint32_t now = 0xFFFFFF00u;
+  schedArm(testSched, 0, now + 500);                             // = 0x000000F4
+  check(runAtMs(now) == 500, "one-shot: idle counts down across the wrap");
+  check(runAtMs(0xFFFFFFFFu) == 245, "one-shot: idle just before the wrap");
+  runAtMs(0xF3);
+  check(runCount[0] == 0, "one-shot: not run before its deadline");
+  runAtMs(0xF4);
+  check(runCount[0] == 1 && runAt[0][0] == 0xF4, "one-shot: run at its deadline");
+  check(!testJobs[0].armed, "one-shot: disarmed after running");
+  check(runAtMs(0x1000) == SCHED_IDLE_MAX_MS, "one-shot: nothing armed -> idle max");
+  check(runCount[0] == 1, "one-shot: not run again");
+}
+
+// 여러 주기를 놓치면 한 번만 실행하고 다음 마감은 지금 + 주기
+static void testMissedPeriods() {
+  reset(1000, 0);
+  uint32_t start = 0xFFFFF000u;
+  schedStart(testSched, start, 0);
+  runAtMs(start);
+  uint32_t late = start + 5500;                                  // 랩 뒤
+  runAtMs(late);
+  check(runCount[0] == 2, "missed: one catch-up run, no burst");
+  check(testJobs[0].due == late + 1000, "missed: next deadline is now + period");
+  check(testJobs[0].lateMaxMs == 4500, "missed: lateness recorded");
+}
+
+// 마감이 지난 두 작업은 마감이 이른 것부터 (랩 앞 마감이 랩 뒤 마감보다 먼저)
+static uint32_t order[4];
+static int orderCount;
+static void orderA() { order[orderCount++] = 0; }
+static void orderB() { order[orderCount++] = 1; }
+
+static void testOrderAcrossWrap() {
+  testJobs[0] = { "a", orderA, 0, 0, false, 0, 0 };
+  testJobs[1] = { "b", orderB, 0, 0, false, 0, 0 };
+  orderCount = 0;
+  schedArm(testSched, 0, 0x10);
+  schedArm(testSched, 1, 0xFFFFFFF0u);
+  runAtMs(0x20);
+  check(orderCount == 2 && order[0] == 1 && order[1] == 0, "order: earlier deadline first across the wrap");
+}
+
+int main() {
+  testDue();
+  testPeriodicAcrossWrap();
+  testOneShotAcrossWrap();
+  testMissedPeriods();
+  testOrderAcrossWrap();
+  hostClearMillis();
+  printf("%d/%d checks pass\n", checks - failures, checks);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,512 @@
+// 호스트(Linux) 빌드용 TFT_eSPI / TFT_eSprite 구현 (RGB565 프레임버퍼)
+// 모든 도형은 drawPixel() 하나로 그림 -> 화면과 스프라이트가 같은 코드를 씀
+#include <TFT_eSPI.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// =========================================
+// 글꼴
+// =========================================
+// GLCD 5x7 (열 단위, bit0 = 맨 윗줄), 0x20 ~ 0x7E
+static const uint8_t glcdFont[95][5] = {
+  {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+  {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x55,0x22,0x50}, {0x00,0x05,0x03,0x00,0x00},
+  {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x14,0x08,0x3E,0x08,0x14}, {0x08,0x08,0x3E,0x08,0x08},
+  {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02},
+  {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31},
+  {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03},
+  {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00},
+  {0x08,0x14,0x22,0x41,0x00}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x51,0x09,0x06},
+  {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+  {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x49,0x49,0x7A},
+  {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+  {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x0C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+  {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31},
+  {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F},
+  {0x63,0x14,0x08,0x14,0x63}, {0x07,0x08,0x70,0x08,0x07}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x7F,0x41,0x41,0x00},
+  {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x7F,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+  {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78}, {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20},
+  {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x08,0x7E,0x09,0x01,0x02}, {0x0C,0x52,0x52,0x52,0x3E},
+  {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x44,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00},
+  {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+  {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x20},
+  {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+  {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+  {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x08,0x04,0x08,0x10,0x08},
+};
+
+static bool glcdBit(uint8_t c, int col, int row) {
+  if (c < 0x20 || c > 0x7E || col < 0 || col >= 5 || row < 0 || row >= 7) return false;
+  return (glcdFont[c - 0x20][col] >> row) & 1;
+}
+
+// FreeFont 대체: 5x7 글꼴을 gw x gh 로 확대 (최근접), 기준선은 글자 바닥
+#define HOST_GFX_GLYPHS 95
+#define HOST_GFX_MAX_BYTES ((12 * 18 + 7) / 8)
+
+struct HostGfxFont {
+  uint8_t bitmap[HOST_GFX_GLYPHS * HOST_GFX_MAX_BYTES];
+  GFXglyph glyph[HOST_GFX_GLYPHS];
+
+  HostGfxFont(int gw, int gh, int adv) {
+    memset(bitmap, 0, sizeof(bitmap));
+    uint32_t off = 0;
+    for (int g = 0; g < HOST_GFX_GLYPHS; g++) {
+      glyph[g] = { off, (uint8_t)gw, (uint8_t)gh, (uint8_t)adv, 0, (int8_t)-gh };
+      uint32_t bit = 0;
+      for (int y = 0; y < gh; y++) {
+        for (int x = 0; x < gw; x++, bit++) {
+          if (glcdBit(0x20 + g, x * 5 / gw, y * 7 / gh)) bitmap[off + bit / 8] |= 0x80 >> (bit & 7);
+        }
+      }
+      off += (bit + 7) / 8;                                   // Adafruit GFX 와 같이 글자마다 바이트 경계에서 시작
+    }
+  }
+};
+
+static HostGfxFont hostFont9(10, 14, 11);
+static HostGfxFont hostFont12(11, 17, 13);
+const GFXfont FreeSansBold9pt7b = { hostFont9.bitmap, hostFont9.glyph, 0x20, 0x7E, 22 };
+const GFXfont FreeSansBold12pt7b = { hostFont12.bitmap, hostFont12.glyph, 0x20, 0x7E, 29 };
+
+// =========================================
+// TFT_eSPI (화면)
+// =========================================
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h) : _init_width(w), _init_height(h), _width(w), _height(h) {}
+
+TFT_eSPI::~TFT_eSPI() { deInitDMA(); }
+
+void TFT_eSPI::init() {
+  fb.assign((size_t)_init_width * _init_height, TFT_BLACK);
+}
+
+void TFT_eSPI::setRotation(uint8_t r) {
+  rotation = r & 3;
+  _width = (rotation & 1) ? _init_height : _init_width;
+  _height = (rotation & 1) ? _init_width : _init_height;
+}
+
+// 회전된 좌표 -> 패널 좌표
+void TFT_eSPI::fbWrite(int32_t x, int32_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height || fb.empty()) return;
+  int32_t px = x, py = y;
+  switch (rotation) {
+    case 1: px = _init_width - 1 - y; py = x; break;
+    case 2: px = _init_width - 1 - x; py = _init_height - 1 - y; break;
+    case 3: px = y; py = _init_height - 1 - x; break;
+  }
+  fb[(size_t)py * _init_width + px] = color;
+  hostPixelWrites++;
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  if (_dmaBusy) hostDmaErrors++;                                // 같은 SPI 버스: DMA 전송 중에는 그리면 안 됨
+  fbWrite(x, y, (uint16_t)color);
+}
+
+uint16_t TFT_eSPI::readPixel(int32_t x, int32_t y) {
+  if (_dmaBusy) hostDmaErrors++;
+  if (x < 0 || y < 0 || x >= _width || y >= _height || fb.empty()) return 0;
+  int32_t px = x, py = y;
+  switch (rotation) {
+    case 1: px = _init_width - 1 - y; py = x; break;
+    case 2: px = _init_width - 1 - x; py = _init_height - 1 - y; break;
+    case 3: px = y; py = _init_height - 1 - x; break;
+  }
+  return fb[(size_t)py * _init_width + px];
+}
+
+void TFT_eSPI::fillScreen(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  int32_t x0 = max(x, (int32_t)0), y0 = max(y, (int32_t)0);
+  int32_t x1 = min(x + w, (int32_t)_width), y1 = min(y + h, (int32_t)_height);
+  for (int32_t j = y0; j < y1; j++)
+    for (int32_t i = x0; i < x1; i++) drawPixel(i, j, color);
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) { fillRect(x, y, w, 1, color); }
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) { fillRect(x, y, 1, h, color); }
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+  int32_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+  int32_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+  int32_t err = dx + dy;
+  for (;;) {
+    drawPixel(x0, y0, color);
+    if (x0 == x1 && y0 == y1) break;
+    int32_t e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x0 += sx; }
+    if (e2 <= dx) { err += dx; y0 += sy; }
+  }
+}
+
+// 원: 중심에서 (x+0.5)^2 + (y+0.5)^2 <= r^2 + r 인 픽셀 (라이브러리의 중점 원과 같은 윤곽)
+void TFT_eSPI::fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  for (int32_t dy = -r; dy <= r; dy++) {
+    int32_t span = 0;
+    while ((span + 1) * (span + 1) + dy * dy <= r * r + r) span++;
+    drawFastHLine(x0 - span, y0 + dy, 2 * span + 1, color);
+  }
+}
+
+void TFT_eSPI::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  int32_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+  drawPixel(x0, y0 + r, color); drawPixel(x0, y0 - r, color);
+  drawPixel(x0 + r, y0, color); drawPixel(x0 - r, y0, color);
+  while (x < y) {
+    if (f >= 0) { y--; ddy += 2; f += ddy; }
+    x++; ddx += 2; f += ddx;
+    drawPixel(x0 + x, y0 + y, color); drawPixel(x0 - x, y0 + y, color);
+    drawPixel(x0 + x, y0 - y, color); drawPixel(x0 - x, y0 - y, color);
+    drawPixel(x0 + y, y0 + x, color); drawPixel(x0 - y, y0 + x, color);
+    drawPixel(x0 + y, y0 - x, color); drawPixel(x0 - y, y0 - x, color);
+  }
+}
+
+void TFT_eSPI::fillEllipse(int16_t x0, int16_t y0, int32_t rx, int32_t ry, uint16_t color) {
+  if (rx < 1 || ry < 1) return;
+  for (int32_t dy = -ry; dy <= ry; dy++) {
+    int32_t span = 0;                                         // (x/rx)^2 + (y/ry)^2 <= 1
+    while ((int64_t)(span + 1) * (span + 1) * ry * ry + (int64_t)dy * dy * rx * rx <= (int64_t)rx * rx * ry * ry) span++;
+    drawFastHLine(x0 - span, y0 + dy, 2 * span + 1, color);
+  }
+}
+
+// 삼각형: 세 변의 같은 쪽(경계 포함)에 있는 픽셀
+void TFT_eSPI::fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color) {
+  int64_t area = (int64_t)(x1 - x0) * (y2 - y0) - (int64_t)(x2 - x0) * (y1 - y0);
+  if (area == 0) { drawLine(x0, y0, x1, y1, color); drawLine(x1, y1, x2, y2, color); return; }
+  int32_t minX = min(x0, min(x1, x2)), maxX = max(x0, max(x1, x2));
+  int32_t minY = min(y0, min(y1, y2)), maxY = max(y0, max(y1, y2));
+  for (int32_t y = minY; y <= maxY; y++) {
+    for (int32_t x = minX; x <= maxX; x++) {
+      int64_t w0 = (int64_t)(x1 - x0) * (y - y0) - (int64_t)(y1 - y0) * (x - x0);
+      int64_t w1 = (int64_t)(x2 - x1) * (y - y1) - (int64_t)(y2 - y1) * (x - x1);
+      int64_t w2 = (int64_t)(x0 - x2) * (y - y2) - (int64_t)(y0 - y2) * (x - x2);
+      bool in = area > 0 ? (w0 >= 0 && w1 >= 0 && w2 >= 0) : (w0 <= 0 && w1 <= 0 && w2 <= 0);
+      if (in) drawPixel(x, y, color);
+    }
+  }
+}
+
+void TFT_eSPI::drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t fg) {
+  int32_t rowBytes = (w + 7) / 8;
+  for (int32_t j = 0; j < h; j++)
+    for (int32_t i = 0; i < w; i++)
+      if (bitmap[j * rowBytes + i / 8] & (0x80 >> (i & 7))) drawPixel(x + i, y + j, fg);
+}
+
+void TFT_eSPI::drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t fg, uint16_t bg) {
+  int32_t rowBytes = (w + 7) / 8;
+  for (int32_t j = 0; j < h; j++)
+    for (int32_t i = 0; i < w; i++)
+      drawPixel(x + i, y + j, (bitmap[j * rowBytes + i / 8] & (0x80 >> (i & 7))) ? fg : bg);
+}
+
+// ---------- 텍스트 ----------
+// GLCD: (x, y) = 글자 칸 왼쪽 위, 배경색이 글자색과 다르면 6x8 칸 전체를 칠함
+void TFT_eSPI::drawGlcdChar(int32_t x, int32_t y, uint8_t c, uint16_t fg, uint16_t bg, uint8_t size) {
+  bool fillBg = bg != fg;
+  for (int col = 0; col < 6; col++) {
+    for (int row = 0; row < 8; row++) {
+      bool on = glcdBit(c, col, row);
+      if (!on && !fillBg) continue;
+      fillRect(x + col * size, y + row * size, size, size, on ? fg : bg);
+    }
+  }
+}
+
+// FreeFont: (x, y) = 기준선 시작점, 배경은 칠하지 않음 (라이브러리와 같음)
+void TFT_eSPI::drawGfxChar(int32_t x, int32_t y, uint8_t c, uint16_t fg, uint8_t size) {
+  if (c < gfxFont->first || c > gfxFont->last) return;
+  const GFXglyph &g = gfxFont->glyph[c - gfxFont->first];
+  const uint8_t* bm = gfxFont->bitmap + g.bitmapOffset;
+  uint32_t bit = 0;
+  for (int yy = 0; yy < g.height; yy++) {
+    for (int xx = 0; xx < g.width; xx++, bit++) {
+      if (bm[bit / 8] & (0x80 >> (bit & 7))) fillRect(x + (g.xOffset + xx) * size, y + (g.yOffset + yy) * size, size, size, fg);
+    }
+  }
+}
+
+int16_t TFT_eSPI::charAdvance(uint8_t c) {
+  if (!gfxFont) return 6 * textsize;
+  if (c < gfxFont->first || c > gfxFont->last) return 0;
+  return gfxFont->glyph[c - gfxFont->first].xAdvance * textsize;
+}
+
+size_t TFT_eSPI::write(uint8_t c) {
+  if (c == '\r') return 1;
+  if (c == '\n') {
+    cursor_x = 0;
+    cursor_y += gfxFont ? gfxFont->yAdvance * textsize : 8 * textsize;
+    return 1;
+  }
+  int16_t adv = charAdvance(c);
+  if (textwrapX && cursor_x + adv > _width) {                 // 라이브러리와 같이 오른쪽 끝에서 줄바꿈
+    cursor_x = 0;
+    cursor_y += gfxFont ? gfxFont->yAdvance * textsize : 8 * textsize;
+  }
+  if (gfxFont) drawGfxChar(cursor_x, cursor_y, c, textcolor, textsize);
+  else drawGlcdChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize);
+  cursor_x += adv;
+  return 1;
+}
+
+size_t TFT_eSPI::print(const char* s) {
+  size_t n = 0;
+  while (*s) n += write((uint8_t)*s++);
+  return n;
+}
+
+int TFT_eSPI::printf(const char* fmt, ...) {
+  char buf[256];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  print(buf);
+  return n;
+}
+
+int16_t TFT_eSPI::textWidth(const char* s) {
+  int16_t w = 0;
+  while (*s) w += charAdvance((uint8_t)*s++);
+  return w;
+}
+
+int16_t TFT_eSPI::fontHeight() {
+  return gfxFont ? gfxFont->yAdvance * textsize : 8 * textsize;
+}
+
+int16_t TFT_eSPI::drawChar(uint16_t c, int32_t x, int32_t y) {
+  if (gfxFont) drawGfxChar(x, y, (uint8_t)c, textcolor, textsize);
+  else drawGlcdChar(x, y, (uint8_t)c, textcolor, textbgcolor, textsize);
+  return charAdvance((uint8_t)c);
+}
+
+// 기준점(datum) 에 맞춰 그리기, 커서는 바꾸지 않음
+int16_t TFT_eSPI::drawString(const char* s, int32_t x, int32_t y) {
+  int16_t w = textWidth(s);
+  int16_t h = gfxFont ? (int16_t)(-gfxFont->glyph['0' - gfxFont->first].yOffset * textsize) : 8 * textsize;   // 글자 윗부분 높이
+  switch (textdatum) {
+    case TC_DATUM: x -= w / 2; break;
+    case TR_DATUM: x -= w; break;
+    case ML_DATUM: y -= h / 2; break;
+    case MC_DATUM: x -= w / 2; y -= h / 2; break;
+    case MR_DATUM: x -= w; y -= h / 2; break;
+    case BL_DATUM: y -= h; break;
+    case BC_DATUM: x -= w / 2; y -= h; break;
+    case BR_DATUM: x -= w; y -= h; break;
+    case L_BASELINE: if (!gfxFont) y -= 7 * textsize; break;
+  }
+  if (gfxFont && textdatum != L_BASELINE) y += h;             // FreeFont 는 기준선 좌표로 그림
+  for (int32_t cx = x; *s; s++) cx += drawChar((uint8_t)*s, cx, y);
+  return w;
+}
+
+// 스왑 안 함(기본) = 버퍼가 이미 SPI 바이트 순서
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data) {
+  for (int32_t j = 0; j < h; j++) {
+    for (int32_t i = 0; i < w; i++) {
+      uint16_t v = data[j * w + i];
+      drawPixel(x + i, y + j, _swapBytes ? v : (uint16_t)((v >> 8) | (v << 8)));
+    }
+  }
+}
+
+// =========================================
+// DMA (작업 스레드)
+// =========================================
+struct TFT_eSPI::HostDma {
+  std::thread worker;
+  std::mutex m;
+  std::condition_variable cv;
+  bool pending = false, quit = false;
+  int32_t x = 0, y = 0, w = 0, h = 0;
+  const uint16_t* data = nullptr;
+  bool swap = false;
+};
+
+bool TFT_eSPI::initDMA(bool) {
+  if (!hostDma) return false;
+  if (_dma) return true;
+  _dma = new HostDma();
+  _dma->worker = std::thread([this] {
+    HostDma &d = *_dma;
+    std::unique_lock<std::mutex> lock(d.m);
+    for (;;) {
+      d.cv.wait(lock, [&] { return d.pending || d.quit; });
+      if (d.quit) return;
+      lock.unlock();
+      std::this_thread::sleep_for(std::chrono::nanoseconds((uint64_t)d.w * d.h * hostDmaNsPerPixel));
+      for (int32_t j = 0; j < d.h; j++) {                       // 전송이 끝나는 시점의 버퍼 내용을 씀
+        for (int32_t i = 0; i < d.w; i++) {
+          uint16_t v = d.data[j * d.w + i];
+          fbWrite(d.x + i, d.y + j, d.swap ? v : (uint16_t)((v >> 8) | (v << 8)));
+        }
+      }
+      lock.lock();
+      d.pending = false;
+      _dmaBusy = false;
+      d.cv.notify_all();
+    }
+  });
+  return true;
+}
+
+void TFT_eSPI::deInitDMA() {
+  if (!_dma) return;
+  {
+    std::lock_guard<std::mutex> lock(_dma->m);
+    _dma->quit = true;
+  }
+  _dma->cv.notify_all();
+  _dma->worker.join();
+  delete _dma;
+  _dma = nullptr;
+  _dmaBusy = false;
+}
+
+void TFT_eSPI::dmaWait() {
+  if (!_dma) return;
+  std::unique_lock<std::mutex> lock(_dma->m);
+  _dma->cv.wait(lock, [&] { return !_dma->pending; });
+}
+
+// 라이브러리처럼 이전 전송이 끝날 때까지 기다린 뒤 시작, 버퍼는 전송이 끝날 때까지 호출한 쪽 소유가 아님
+void TFT_eSPI::pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data, uint16_t*) {
+  if (!_dma) { pushImage(x, y, w, h, data); return; }
+  if (!_inTransaction) hostDmaErrors++;
+  dmaWait();
+  {
+    std::lock_guard<std::mutex> lock(_dma->m);
+    _dma->x = x; _dma->y = y; _dma->w = w; _dma->h = h;
+    _dma->data = data;
+    _dma->swap = _swapBytes;
+    _dma->pending = true;
+    _dmaBusy = true;
+  }
+  hostDmaTransfers++;
+  _dma->cv.notify_all();
+}
+
+void TFT_eSPI::endWrite() {
+  if (_dmaBusy) hostDmaErrors++;                                // 펌웨어는 dmaWait() 후에 endWrite()
+  _inTransaction = false;
+}
+
+// =========================================
+// TFT_eSprite
+// =========================================
+TFT_eSprite::TFT_eSprite(TFT_eSPI* tft) : TFT_eSPI(0, 0), _tft(tft) {}
+
+void* TFT_eSprite::setColorDepth(int8_t b) {
+  _bpp = (b == 1 || b == 4) ? b : 16;
+  return _img;
+}
+
+void* TFT_eSprite::createSprite(int16_t w, int16_t h, uint8_t) {
+  if (_img) return _img;
+  if (_bpp == 4) w = (w + 1) & ~1;                              // 라이브러리: 4비트는 폭을 짝수로
+  _init_width = _width = w;
+  _init_height = _height = h;
+  size_t bytes;
+  if (_bpp == 1) { _rowBytes = (w + 7) / 8; bytes = (size_t)_rowBytes * h; }
+  else if (_bpp == 4) bytes = (size_t)w * h / 2;
+  else bytes = (size_t)w * h * 2;
+  _img = (uint8_t*)calloc(bytes ? bytes : 1, 1);
+  _heapBytes = bytes + (_bpp == 4 ? 16 * sizeof(uint16_t) : 0);  // 라이브러리는 4비트 팔레트(_colorMap)도 힙에 둠
+  hostHeapUsed += _heapBytes;
+  if (_bpp == 4) {                                              // 라이브러리 기본 팔레트 앞부분
+    static const uint16_t def[16] = { TFT_BLACK, TFT_NAVY, TFT_DARKGREEN, TFT_DARKCYAN, TFT_MAROON, TFT_PURPLE, TFT_OLIVE, TFT_LIGHTGREY,
+                                      TFT_DARKGREY, TFT_BLUE, TFT_GREEN, TFT_CYAN, TFT_RED, TFT_MAGENTA, TFT_YELLOW, TFT_WHITE };
+    memcpy(_palette, def, sizeof(_palette));
+  }
+  _sx = _sy = 0; _sw = w; _sh = h;
+  return _img;
+}
+
+void TFT_eSprite::deleteSprite() {
+  free(_img);
+  _img = nullptr;
+  hostHeapUsed -= _heapBytes;
+  _heapBytes = 0;
+  _width = _height = 0;
+}
+
+void TFT_eSprite::createPalette(const uint16_t* colors, uint8_t n) {
+  for (int i = 0; i < n && i < 16; i++) _palette[i] = colors[i];
+}
+
+void TFT_eSprite::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  if (!_img || x < 0 || y < 0 || x >= _width || y >= _height) return;
+  if (_bpp == 16) {
+    ((uint16_t*)_img)[y * _width + x] = (uint16_t)((color >> 8) | (color << 8));
+  } else if (_bpp == 4) {
+    uint8_t &b = _img[(y * _width + x) >> 1];
+    b = (x & 1) ? (uint8_t)((b & 0xF0) | (color & 0x0F)) : (uint8_t)((b & 0x0F) | ((color & 0x0F) << 4));
+  } else {
+    uint8_t &b = _img[y * _rowBytes + (x >> 3)];
+    if (color) b |= 0x80 >> (x & 7); else b &= ~(0x80 >> (x & 7));
+  }
+}
+
+// 저장된 값 (16비트: RGB565, 4비트: 팔레트 번호, 1비트: 0/1)
+uint16_t TFT_eSprite::readPixelValue(int32_t x, int32_t y) {
+  if (!_img || x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+  if (_bpp == 16) { uint16_t v = ((uint16_t*)_img)[y * _width + x]; return (uint16_t)((v >> 8) | (v << 8)); }
+  if (_bpp == 4) { uint8_t b = _img[(y * _width + x) >> 1]; return (x & 1) ? (b & 0x0F) : (b >> 4); }
+  return (_img[y * _rowBytes + (x >> 3)] >> (7 - (x & 7))) & 1;
+}
+
+// 화면에 보일 색 (RGB565)
+uint16_t TFT_eSprite::readPixel(int32_t x, int32_t y) {
+  uint16_t v = readPixelValue(x, y);
+  if (_bpp == 4) return _palette[v & 0x0F];
+  if (_bpp == 1) return v ? _bitmap_fg : _bitmap_bg;
+  return v;
+}
+
+void TFT_eSprite::pushSpriteImpl(int32_t x, int32_t y, bool useTransparent, uint16_t transparent) {
+  if (!_img || !_tft) return;
+  for (int32_t j = 0; j < _height; j++) {
+    for (int32_t i = 0; i < _width; i++) {
+      uint16_t c = readPixel(i, j);
+      if (useTransparent && c == transparent) continue;
+      _tft->drawPixel(x + i, y + j, c);
+    }
+  }
+}
+
+void TFT_eSprite::pushSprite(int32_t x, int32_t y) { pushSpriteImpl(x, y, false, 0); }
+void TFT_eSprite::pushSprite(int32_t x, int32_t y, uint16_t transparent) { pushSpriteImpl(x, y, true, transparent); }
+
+void TFT_eSprite::setScrollRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+  _sx = x; _sy = y; _sw = w; _sh = h; _scolor = color;
+}
+
+// 스크롤 사각형 안을 (dx, dy) 만큼 이동, 비워진 곳은 setScrollRect 의 색
+void TFT_eSprite::scroll(int16_t dx, int16_t dy) {
+  if (!_img) return;
+  std::vector<uint16_t> tmp((size_t)_sw * _sh);
+  for (int32_t j = 0; j < _sh; j++)
+    for (int32_t i = 0; i < _sw; i++) tmp[j * _sw + i] = readPixelValue(_sx + i, _sy + j);
+  for (int32_t j = 0; j < _sh; j++) {
+    for (int32_t i = 0; i < _sw; i++) {
+      int32_t si = i - dx, sj = j - dy;
+      bool inside = si >= 0 && sj >= 0 && si < _sw && sj < _sh;
+      drawPixel(_sx + i, _sy + j, inside ? tmp[sj * _sw + si] : _scolor);
+    }
+  }
+}
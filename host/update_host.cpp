@@ -0,0 +1,94 @@
+// 호스트 빌드용 Update(OTA): 메모리에 받은 이미지를 end() 에서 검증 (ESP 이미지 매직 0xE9, MD5)
+#include <Update.h>
+#include <strings.h>
+
+// RFC 1321 MD5
+static uint32_t rol(uint32_t x, int c) { return (x << c) | (x >> (32 - c)); }
+
+void hostMd5Hex(const uint8_t* data, size_t len, char out[33]) {
+  static const uint32_t K[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391 };
+  static const int R[64] = {
+    7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+    4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21 };
+
+  std::vector<uint8_t> msg(data, data + len);
+  msg.push_back(0x80);
+  while (msg.size() % 64 != 56) msg.push_back(0);
+  uint64_t bits = (uint64_t)len * 8;
+  for (int i = 0; i < 8; i++) msg.push_back((uint8_t)(bits >> (8 * i)));
+
+  uint32_t h[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+  for (size_t off = 0; off < msg.size(); off += 64) {
+    uint32_t w[16];
+    for (int i = 0; i < 16; i++) {
+      const uint8_t* p = &msg[off + i * 4];
+      w[i] = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+    for (int i = 0; i < 64; i++) {
+      uint32_t f;
+      int g;
+      if (i < 16)      { f = (b & c) | (~b & d); g = i; }
+      else if (i < 32) { f = (d & b) | (~d & c); g = (5 * i + 1) % 16; }
+      else if (i < 48) { f = b ^ c ^ d;          g = (3 * i + 5) % 16; }
+      else             { f = c ^ (b | ~d);       g = (7 * i) % 16; }
+      uint32_t t = d;
+      d = c;
+      c = b;
+      b = b + rol(a + f + K[i] + w[g], R[i]);
+      a = t;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+  }
+  for (int i = 0; i < 16; i++) snprintf(out + i * 2, 3, "%02x", (h[i / 4] >> (8 * (i % 4))) & 0xFF);
+}
+
+static void setError(char* dst, const char* msg) { snprintf(dst, 48, "%s", msg); }
+
+bool UpdateClass::begin(size_t, int) {
+  hostBegins++;
+  hostImage.clear();
+  hostCommitted = false;
+  _md5[0] = '\0';
+  _error[0] = '\0';
+  _running = true;
+  return true;
+}
+
+bool UpdateClass::setMD5(const char* expectedMd5) {
+  if (strlen(expectedMd5) != 32) return false;
+  snprintf(_md5, sizeof(_md5), "%s", expectedMd5);
+  return true;
+}
+
+size_t UpdateClass::write(uint8_t* data, size_t len) {
+  if (!_running || hasError()) return 0;
+  if (hostFailWriteAt && hostImage.size() + len > hostFailWriteAt) { setError(_error, "Flash Write Failed"); return 0; }
+  hostImage.insert(hostImage.end(), data, data + len);
+  return len;
+}
+
+bool UpdateClass::end(bool) {
+  if (!_running) return false;
+  _running = false;
+  if (hostImage.empty() || hostImage[0] != 0xE9) { setError(_error, "Magic byte is wrong, not 0xE9"); return false; }
+  char md5[33];
+  hostMd5Hex(hostImage.data(), hostImage.size(), md5);
+  if (_md5[0] && strcasecmp(md5, _md5) != 0) { setError(_error, "MD5 Check Failed"); return false; }
+  hostCommitted = true;
+  return true;
+}
+
+void UpdateClass::abort() {
+  hostAborts++;
+  _running = false;
+  setError(_error, "Aborted");
+}
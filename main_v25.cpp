@@ -25,8 +25,16 @@
 #include <Preferences.h>
 #include <time.h>
 #include <Wire.h>
+#include <Update.h>
+#include <esp_heap_caps.h>
 
 #include <esp_task_wdt.h> // [추가] 와치독 타이머 라이브러리
+#include <freertos/FreeRTOS.h> // [추가] 센서/제어 태스크 분리
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/event_groups.h> // [추가] 웹 핸들러가 제어 명령 적용을 기다림
+#include <atomic>                   // [추가] 상태 스냅샷 seqlock
+#include <esp_timer.h>              // [추가] 버튼 디바운스 타이머
 #define WDT_TIMEOUT 30    // 10초 동안 응답 없으면 재부팅
 
 
@@ -119,7 +127,6 @@ int currentSensorType = 0;               // 0: SHT41, 1: AHT20+BMP280
 
 #define SAMPLE_INTERVAL 1000          // 온/습도 센서
 #define GRAPH_SAMPLE_INTERVAL_SEC 12  // 그래프용 샘플 간격(초) (10,15,20 선택 가능)
-unsigned long lastGraphSampleMs = 0;   // 그래프용 마지막 push 시간
 
 // ================== Log Configuration ==================
 // ===== RAM Buffer for TFT Display (24 Hours) =====
@@ -136,9 +143,35 @@ unsigned long lastGraphSampleMs = 0;   // 그래프용 마지막 push 시간
 struct LogRecord {
   uint32_t ts;   // epoch (UTC)
   int16_t temp;    // 10배 확대된 값 (ex: 25.3°C → 253)
-  int16_t humi;    // 10배 확대된 값 (ex: 60.2% → 602)
+  int16_t humi_act; // [수정] 하위 13비트: 습도 10배 값 (ex: 60.2% → 602), 상위 3비트: 액추에이터 상태 -> recHumi()/recActuators() 로 읽음
 };
 
+// [추가] 액추에이터 동작 기록 (레코드 크기 8바이트 유지)
+// 습도는 0~1000 이므로 13비트로 충분, 남는 상위 3비트에 샘플 구간 동안 한 번이라도 켜졌던 액추에이터를 OR 해서 저장
+// 이전 형식 레코드: 유효 습도는 상위 비트가 0 -> 액추에이터 없음, 무효값(-9999) 은 그대로 무효로 읽힘
+#define ACT_HEATER       0x01
+#define ACT_HUMIDIFIER   0x02
+#define ACT_FAN          0x04
+#define NUM_ACT_BANDS    3
+#define HUMI_ACT_SHIFT   13
+#define HUMI_VALUE_MASK  0x1FFF                                  // 이 값이면 습도 무효
+
+int16_t recHumi(const LogRecord &rec) {
+  if (rec.humi_act == INVALID_VALUE) return INVALID_VALUE;
+  uint16_t v = (uint16_t)rec.humi_act & HUMI_VALUE_MASK;
+  return v == HUMI_VALUE_MASK ? (int16_t)INVALID_VALUE : (int16_t)v;
+}
+
+uint8_t recActuators(const LogRecord &rec) {
+  if (rec.humi_act == INVALID_VALUE) return 0;
+  return (uint16_t)rec.humi_act >> HUMI_ACT_SHIFT;
+}
+
+int16_t packHumi(int16_t h10, uint8_t act) {
+  uint16_t v = (h10 == INVALID_VALUE) ? HUMI_VALUE_MASK : (uint16_t)constrain((int)h10, 0, 1000);
+  return (int16_t)(v | ((uint16_t)(act & 0x07) << HUMI_ACT_SHIFT));
+}
+
 
 struct LogMeta {
   uint32_t head_index;     // 다음 레코드가 기록될 위치 (포인터)
@@ -176,18 +209,52 @@ String loginPass = "cage1234";  // 기본값
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 int screenRotation = 0; // 0: Portrait(세로), 1: Landscape(가로)
-int layout_face_y = 0;
-int layout_face_x = 0;        // 가로모드일때 얼굴좌표
-int layout_icons_y = 0;
-int layout_graph_x = 0;
-int layout_graph_y = 0;
-int layout_graph_w = 0;
-int layout_graph_h = 0;
-int layout_num_labels = 0;
 
+// [수정] 화면 방향별 배치표 (constexpr)
+// 그리기 함수는 방향마다 템플릿으로 따로 만들어져 이 표의 값이 상수로 들어감 (screenRotation 분기 없음)
+// updateLayout() 은 layout / uiRenderer 포인터만 바꿈
+struct ScreenLayout {
+  const char* headline;
+  int info_x_time, info_x_temp, info_x_humi, info_x_end;     // 상단 정보줄 칸 경계
+  int info_text_x_time;                                      // 시계 글자 시작
+  int face_cx, face_y;                                       // 얼굴 중심 (face_y < 0 이면 그리지 않음)
+  int face_clear_x, face_clear_w;                            // 얼굴 위젯 사각형 가로 범위
+  int status_x, status_dy1, status_dy2;                      // 상태 문구 위치 (face_y 기준)
+  int status_clear_w;                                        // > 0 이면 문구 칸이 얼굴 사각형 밖 -> 따로 지움
+  int icons_y, icon_x_start, icon_gap;
+  int icon_min_x;                                            // 아이콘 칸 왼쪽 한계 (가로 모드: 얼굴 영역 보호)
+  int graph_x, graph_y, graph_w, graph_h;
+  int num_labels;                                            // X축 그리드
+  int ylabel_dx, ylabel_dy, y0label_dx, y0label_dy;          // Y축 라벨 / 최솟값 라벨 위치 보정 (왼쪽: 온도)
+  int hlabel_dx;                                             // [추가] 습도 Y축 라벨 (그래프 오른쪽 끝 기준)
+  int xlabel_dx, xlabel_dy;                                  // X축 라벨 위치 보정
+};
 
-// 헤드라인 텍스트도 방향에 따라 다를 수 있음
-String headlineText = "Lizard Monitor";
+constexpr ScreenLayout SCREEN_LAYOUTS[2] = {
+  { // --- 세로 모드 (Portrait) ---
+    "   Lizard Guidian",
+    0, 95, 170, 240, 5,
+    110, 115 - 16, 0, 240,
+    5, -15, 5, 0,
+    160, 30, 60, 0,
+    18, 190, 210 + 10 - 20, 100, 7,                          // [수정] 오른쪽 20px 은 습도 Y축 라벨
+    -16, -2, -8, -4,
+    3,
+    -20 + 4, 5,
+  },
+  { // --- 가로 모드 (Landscape) ---  얼굴은 정보줄 옆 좌측 상단, 아이콘은 우측으로 75px 이동
+    "  Lizard Cage Monitoring",
+    140, 200, 260, 320, 145,
+    40, 72, 40 - 28 - 10, 28 * 2 + 20,
+    5 + 70 - 2, -24, -14, 64,
+    180 - 100 + 8, 30 + 75, 60, 90,
+    20, 66 + 50, 240 + 40 + 10 + 6 - 20, 100 + 10, 7,
+    -18, -4, -12, -6,
+    3,
+    -14 + 4, 6,
+  },
+};
+const ScreenLayout* layout = &SCREEN_LAYOUTS[0];
 
 
 
@@ -196,6 +263,7 @@ String headlineText = "Lizard Monitor";
 
 #define Y_MIN 0
 #define Y_MAX 80
+#define GRAPH_Y_AUTOSCALE 1                 // [추가] 1: 보이는 구간의 min/max 로 Y축 자동 조정, 0: Y_MIN ~ Y_MAX 고정
 
 int displayHours = 1;
 int displayHoursIndex = 0;   // 현재 선택 인덱스
@@ -208,6 +276,7 @@ const int displayHoursOptions[NUM_GRAPH_MODES] = {1, 6, 12, 24};
 int graphIndex = 0;     // 다음 데이터 입력 위치
 float accTemp = 0;
 float accHumi = 0;
+uint8_t accAct = 0;                       // [추가] 구간 동안 켜졌던 액추에이터 (ACT_* OR)
 int accCount = 0;
 
 unsigned long lastNtpSync = 0;                                            // ntpUpdate()
@@ -255,8 +324,7 @@ bool longPressActive = false;
 
 int brightnessStep[2] = {0, 0};
 int selectedLED = 0;
-uint8_t lastEncState = 0;
-bool btnPrevState = HIGH;
+volatile uint8_t lastEncState = 0;     // [수정] 엔코더 ISR 에서 갱신
 unsigned long encoderPressStart = 0;
 const unsigned long LONG_PRESS_MS = 10000;
 
@@ -277,62 +345,156 @@ unsigned long lastTimeAxisTick = 0;
 TFT_eSPI tft;
 TFT_eSprite graphSprite = TFT_eSprite(&tft); // [추가] 그래프용 스프라이트 선언
 
+// [추가] 그래프 스프라이트 색 깊이: 4 (16색 팔레트, 276x110 = 15KB) 또는 16 (RGB565, 65KB)
+// 그래프에는 배경/격자/온도/습도 + 액추에이터 띠 3색만 쓰므로 4비트 팔레트로 충분, 전송할 때 RGB565 로 펼침
+#define GRAPH_SPRITE_BPP 4
 
-float lastTemp = NAN;
+enum GraphColor { GC_BG, GC_GRID, GC_TEMP, GC_HUMI, GC_HEATER, GC_HUMIDIFIER, GC_FAN, NUM_GRAPH_COLORS };
+const uint16_t graphPalette[NUM_GRAPH_COLORS] = { BG_COLOR, GRID_COLOR, TFT_YELLOW, TFT_GREEN,
+                                                  0x7800, TFT_DARKCYAN, TFT_DARKGREEN };   // [추가] 띠는 곡선보다 어둡게
+uint32_t graphSpriteBytes = 0;               // 스프라이트가 실제로 차지한 힙 (생성 전후 차이)
+int32_t graphSpriteReclaimedBytes = 0;       // 16비트 스프라이트 대비 절약한 힙
+
+// 그래프 스프라이트에 그릴 때 쓰는 색 값 (4비트: 팔레트 인덱스, 16비트: RGB565)
+uint16_t graphColor(GraphColor c) {
+#if GRAPH_SPRITE_BPP == 4
+  return (uint16_t)c;
+#else
+  return graphPalette[c];
+#endif
+}
+
+
+float lastTemp = NAN;                       // [수정] controlTask 전용 (다른 태스크는 readState())
 float lastHumi = NAN;
 int pwmValue[2] = {0, 0};
-unsigned long lastSample = 0;
 
-WebServer server(80);
+// [추가] controlTask 가 측정/제어 후 발행하는 상태 스냅샷 (화면, 웹은 복사본만 읽음)
+struct CageState {
+  float temp, humi;                         // NAN = 읽기 실패
+  uint32_t sampleMs;                        // 측정 시각 (millis)
+  uint8_t act;                              // 켜져 있는 액추에이터 (ACT_*)
+  uint32_t seq;                             // 발행 번호 (0 = 아직 측정 전)
+};
+
+// [수정] 잠금 없는 seqlock: 쓰는 쪽(controlTask 하나)은 시작할 때 번호를 홀수로, 끝나면 짝수로 올림
+// 읽는 쪽은 번호가 짝수이고 복사 전후로 같을 때만 채택 -> 어느 코어/태스크에서 읽어도 온습도/시각/액추에이터가 한 묶음
+// 임계구역(portMUX) 과 달리 읽는 쪽이 인터럽트를 막거나 쓰는 쪽을 기다리게 하지 않음
+std::atomic<uint32_t> cageStateSeq(0);
+CageState cageStateData = { NAN, NAN, 0, 0, 0 };
+std::atomic<uint32_t> cageStateRetries(0);     // 쓰는 중에 걸려 다시 읽은 횟수 (/metrics)
+
+void publishState(float t, float h, uint8_t act) {
+  uint32_t seq = cageStateSeq.load(std::memory_order_relaxed);
+  cageStateSeq.store(seq + 1, std::memory_order_relaxed);      // 홀수 = 쓰는 중
+  std::atomic_thread_fence(std::memory_order_release);
+  cageStateData.temp = t;
+  cageStateData.humi = h;
+  cageStateData.sampleMs = millis();
+  cageStateData.act = act;
+  cageStateData.seq = seq / 2 + 1;
+  cageStateSeq.store(seq + 2, std::memory_order_release);
+}
+
+CageState readState() {
+  for (uint32_t tries = 0; ; tries++) {
+    uint32_t seq0 = cageStateSeq.load(std::memory_order_acquire);
+    CageState s;
+    memcpy(&s, (const void*)&cageStateData, sizeof(s));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!(seq0 & 1) && cageStateSeq.load(std::memory_order_relaxed) == seq0) return s;
+    cageStateRetries.fetch_add(1, std::memory_order_relaxed);
+    if (tries >= 8) taskYIELD();                                  // 같은 코어의 쓰는 쪽을 선점한 경우 양보
+  }
+}
+
+// [추가] 응답 본문 바이트 계측용 WebServer
+// 이 파일에서 쓰는 send/sendContent 계열만 가로채서 누적한 뒤 원래 함수로 넘김 (헤더 바이트는 제외)
+class InstrumentedWebServer : public WebServer {
+public:
+  using WebServer::WebServer;
+  uint32_t bytesSent = 0;
+
+  void send(int code, const char* contentType, const String& content) { bytesSent += content.length(); WebServer::send(code, contentType, content); }
+  void send_P(int code, PGM_P contentType, PGM_P content) { bytesSent += strlen_P(content); WebServer::send_P(code, contentType, content); }
+  void sendContent(const String& content) { bytesSent += content.length(); WebServer::sendContent(content); }
+  void sendContent(const char* content, size_t size) { bytesSent += size; WebServer::sendContent(content, size); }
+  void sendContent_P(PGM_P content) { bytesSent += strlen_P(content); WebServer::sendContent_P(content); }
+};
+
+InstrumentedWebServer server(80);
 Preferences preferences;
 bool externalAPConnected = false;
 
 
+// ================= Runtime Statistics (/metrics) =================
+// [추가] 액추에이터별 누적 동작시간
+struct ActuatorStat {
+  const char* name;
+  uint8_t pin;
+  uint8_t act;                        // [추가] 스냅샷의 ACT_* 비트
+  uint64_t onMs;
+};
+ActuatorStat actuatorStats[] = {
+  { "humidifier", HUMIDIFIER_PWR, ACT_HUMIDIFIER, 0 },
+  { "heater",     HEATER_PIN,     ACT_HEATER,     0 },
+  { "fan",        FAN_PIN,        ACT_FAN,        0 },
+};
+#define NUM_ACTUATORS (sizeof(actuatorStats) / sizeof(actuatorStats[0]))
+unsigned long lastActuatorStatMs = 0;
+
+// [추가] 센서 읽기 통계
+uint32_t sensorReadCount = 0;
+uint32_t sensorErrorCount = 0;
+uint32_t sensorConsecutiveErrors = 0;
+
+// [추가] 센서별 측정 지연 (트리거 ~ 결과 수신, 성공한 측정만)
+struct SensorLatency {
+  const char* name;
+  uint32_t lastUs = 0, maxUs = 0, count = 0;
+  uint64_t totalUs = 0;
+  uint32_t polls = 0;                 // 변환 시간이 지났는데도 아직 변환 중이라 다시 읽은 횟수
+};
+SensorLatency sensorLatency[2] = { { "sht41" }, { "aht20" } };
+
+// 진행 중인 측정
+struct SensorMeasurement {
+  bool busy;
+  uint8_t polls;
+  uint32_t startUs;
+};
+SensorMeasurement sensorMeas = { false, 0, 0 };
+
+// [추가] loop() 1회 실행시간 히스토그램 (버킷 b = [2^b, 2^(b+1)) us), 1분 단위로 창을 교체
+#define LOOP_HIST_BUCKETS 21                  // 최대 ~1초
+#define LOOP_HIST_WINDOW_MS 60000
+uint32_t loopHist[LOOP_HIST_BUCKETS];
+uint32_t loopHistPrev[LOOP_HIST_BUCKETS];     // 직전 1분 (백분위 계산용)
+uint32_t loopMaxUs = 0, loopMaxUsPrev = 0;
+unsigned long loopHistStartMs = 0;
+
+
 
 // =========================================
 // Forward Declarations
 // =========================================
 void lcdPrint(const char* msg);
-void drawGraph();
+bool drawGraph(uint32_t budgetUs = 0);
+extern TaskHandle_t loopTaskHandle;
+void drawHistoryGraph();
+void histCacheClear();
+void histClampView();
+void histPan(int steps);
 void checkHumidity();
 void checkTemperature();
+void updateActuatorStats(unsigned long nowMs);
+void printHttpStats();
 void handleDashboard();
 
 
 
 #define TFT_WIDTH_OFFSET  20          // User_Setup.h 에 정의되어 있음 //  텍스트 자동 줄바뀜 방지를 위한 가상공간 확보
 
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// [수정 2] 회전 모드에 따른 좌표 설정 함수
-
-void updateLayout() {
-  if (screenRotation == 0) { 
-    // --- 세로 모드 (Portrait) ---
-    layout_face_y = 115-16;
-    layout_icons_y = 160;// + 120;
-    layout_graph_x = 18;
-    layout_graph_y = 190;
-    layout_graph_w = 210+10;
-    layout_graph_h = 100;
-    layout_num_labels = 7;                  // X축 그리드
-    headlineText = "   Lizard Guidian";
-  } 
-  else { 
-
-    // [수정] 얼굴 아이콘 배치 (숨김 해제 -> 우측 상단 배치)
-    layout_face_x = 285;                // [중요] 화면 우측 끝부분으로 X좌표 설정
-    layout_face_y = 72; //80; //60;     // [중요] 화면 상단(정보창 옆)으로 Y좌표 설정 (-100 아님)
-
-    // [유지] 아래는 사용자가 지정한 가로모드 배치값 그대로 유지
-    layout_icons_y = 180 - 100 + 8; 
-    layout_graph_x = 20;
-    layout_graph_y = 66 + 50;
-    layout_graph_w = 240 + 40 + 10 + 6;
-    layout_graph_h = 100 + 10;
-    layout_num_labels = 7;
-    headlineText = "  Lizard Cage Monitoring";
-  }
-}
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -445,14 +607,213 @@ void readLogRecord(LogRecord& record, uint32_t index) {
   }
 }
 
+// =========================================
+// [추가] 그래프 컬럼 엔벨로프 (모드별 min/max 캐시)
+// =========================================
+// 6H/12H/24H 에서는 한 픽셀 컬럼에 수십 개 샘플이 들어가므로 샘플마다 선을 긋지 않고
+// 모드별로 컬럼 단위 min/max 를 샘플이 들어올 때마다 누적해 둠
+// -> 그리기는 O(그래프 폭), 순간 튀는 값은 세로 막대로 보이고, 모드 전환은 즉시
+#define GRAPH_ENV_COLS 276                  // 최대 그래프 폭 (LANDSCAPE layout->graph_w)
+
+struct GraphEnvCol {
+  uint32_t col;                             // 이 슬롯의 절대 컬럼 번호
+  int16_t tMin, tMax, tFrom;                // 온도 min/max, 앞 컬럼에서 이어지는 값 (INVALID_VALUE = 연결 없음)
+  int16_t hMin, hMax, hFrom;                // 습도
+  uint8_t act;                              // [추가] 이 컬럼 동안 켜졌던 액추에이터 (ACT_* OR)
+};
+
+struct GraphEnvelope {
+  uint32_t lastCol;                         // 마지막 샘플이 들어간 컬럼
+  uint32_t lastValidTs;                     // 데이터 공백 판단용
+  int16_t lastTemp, lastHumi;               // 다음 컬럼으로 이어질 값 (INVALID_VALUE = 끊김)
+  GraphEnvCol cols[GRAPH_ENV_COLS];         // 절대 컬럼 % GRAPH_ENV_COLS 링
+};
+GraphEnvelope graphEnv[NUM_GRAPH_MODES];
+
+uint32_t graphWindowSec(int mode) {
+  return (uint32_t)displayHoursOptions[mode] * 3600UL;
+}
+
+// [수정] ts * w / window 를 64비트 나눗셈(소프트웨어) 없이 계산: ts = q * window + r
+// r * w < 86400 * 276 이므로 32비트 나눗셈 2번으로 정확히 같은 값
+uint32_t graphColumnFor(uint32_t ts, uint32_t windowSec) {
+  uint32_t q = ts / windowSec;
+  uint32_t r = ts % windowSec;
+  return q * layout->graph_w + (r * layout->graph_w) / windowSec;
+}
+
+GraphEnvCol &graphEnvSlot(GraphEnvelope &env, uint32_t col) {
+  GraphEnvCol &e = env.cols[col % GRAPH_ENV_COLS];
+  if (e.col != col) {                       // 한 바퀴 지난 슬롯 재사용
+    e.col = col;
+    e.tMin = e.tMax = e.tFrom = INVALID_VALUE;
+    e.hMin = e.hMax = e.hFrom = INVALID_VALUE;
+    e.act = 0;
+  }
+  return e;
+}
+
+// [추가] 현재 Y축 범위 (0.1 단위), 격자 간격은 step10
+// [수정] 온도/습도는 범위가 달라 (26~30도 vs 50~70%) 계열마다 축을 따로 둠: 온도 라벨은 왼쪽, 습도 라벨은 오른쪽 (웹 차트와 같음)
+enum GraphSeries { GS_TEMP, GS_HUMI, NUM_GRAPH_SERIES };
+
+struct GraphYAxis {
+  int16_t lo10, hi10, step10;
+};
+GraphYAxis graphYAxis[NUM_GRAPH_SERIES] = { { Y_MIN * 10, Y_MAX * 10, 200 }, { Y_MIN * 10, Y_MAX * 10, 200 } };
+uint32_t graphYRescales = 0;                                      // 범위가 바뀌어 전체 다시 그린 횟수
+
+// [추가] Y축 자동 조정용 구간 min/max (현재 모드만)
+// 컬럼 단위 단조 덱: 최솟값 덱은 값이 증가하는 순서, 최댓값 덱은 감소하는 순서로 유지
+// 새 샘플은 뒤에서 자기보다 나쁜 값을 밀어내고, 화면 왼쪽을 벗어난 컬럼은 앞에서 빠짐 -> 샘플당 O(1)
+struct GraphRangeEntry {
+  uint32_t col;
+  int16_t v;
+};
+
+struct GraphRangeDeque {
+  GraphRangeEntry e[GRAPH_ENV_COLS];
+  uint16_t head, count;
+};
+GraphRangeDeque graphRangeMin[NUM_GRAPH_SERIES], graphRangeMax[NUM_GRAPH_SERIES];   // [수정] 계열별
+
+void graphRangeClear() {
+  for (int s = 0; s < NUM_GRAPH_SERIES; s++) {
+    graphRangeMin[s].head = graphRangeMin[s].count = 0;
+    graphRangeMax[s].head = graphRangeMax[s].count = 0;
+  }
+}
+
+// 같은 컬럼(마지막 컬럼)에 샘플이 더 들어오면 뒤 항목을 갱신
+void graphRangePush(GraphRangeDeque &dq, uint32_t col, int16_t v, bool isMax) {
+  GraphRangeEntry* back = dq.count ? &dq.e[(dq.head + dq.count - 1) % GRAPH_ENV_COLS] : nullptr;
+  if (back && back->col == col) {
+    if (isMax ? back->v >= v : back->v <= v) return;
+    dq.count--;
+  }
+  while (dq.count) {
+    back = &dq.e[(dq.head + dq.count - 1) % GRAPH_ENV_COLS];
+    if (isMax ? back->v > v : back->v < v) break;
+    dq.count--;
+  }
+  if (dq.count == GRAPH_ENV_COLS) {         // 오래 그리지 않아 꽉 참 -> 가장 오래된 컬럼부터 버림
+    dq.head = (dq.head + 1) % GRAPH_ENV_COLS;
+    dq.count--;
+  }
+  dq.e[(dq.head + dq.count) % GRAPH_ENV_COLS] = { col, v };
+  dq.count++;
+}
+
+void graphRangeEvict(GraphRangeDeque &dq, uint32_t leftCol) {
+  while (dq.count && dq.e[dq.head].col < leftCol) {
+    dq.head = (dq.head + 1) % GRAPH_ENV_COLS;
+    dq.count--;
+  }
+}
+
+// 엔벨로프 컬럼 하나의 온도/습도 min/max 를 각 계열의 덱에 반영
+void graphRangeAddCol(const GraphEnvCol &e) {
+  if (e.tMin != INVALID_VALUE) {
+    graphRangePush(graphRangeMin[GS_TEMP], e.col, e.tMin, false);
+    graphRangePush(graphRangeMax[GS_TEMP], e.col, e.tMax, true);
+  }
+  if (e.hMin != INVALID_VALUE) {
+    graphRangePush(graphRangeMin[GS_HUMI], e.col, e.hMin, false);
+    graphRangePush(graphRangeMax[GS_HUMI], e.col, e.hMax, true);
+  }
+}
+
+void graphEnvAccumulate(int16_t v, int16_t &mn, int16_t &mx, int16_t &from, int16_t &last) {
+  if (v == INVALID_VALUE) { last = INVALID_VALUE; return; }
+  if (mn == INVALID_VALUE) { from = last; mn = mx = v; }       // 컬럼의 첫 값: 앞 컬럼 마지막 값에서 이어짐
+  else { if (v < mn) mn = v; if (v > mx) mx = v; }
+  last = v;
+}
+
+void graphEnvelopeAdd(int mode, const LogRecord &rec) {
+  GraphEnvelope &env = graphEnv[mode];
+  if (rec.ts == 0 || rec.ts == 0xFFFFFFFF) return;
+
+  uint32_t col = graphColumnFor(rec.ts, graphWindowSec(mode));
+
+  if (env.lastValidTs != 0 && (rec.ts - env.lastValidTs) > (GRAPH_SAMPLE_INTERVAL_SEC * 1.5)) {
+    env.lastTemp = env.lastHumi = INVALID_VALUE;                // 데이터 공백 -> 선 끊기
+  } else if (env.lastValidTs != 0 && col > env.lastCol + 1 && col - env.lastCol < GRAPH_ENV_COLS) {
+    // 샘플 없이 건너뛴 컬럼 (1H 모드에서 간혹 발생) 은 직전 값으로 이어 붙임
+    for (uint32_t c = env.lastCol + 1; c < col; c++) {
+      GraphEnvCol &e = graphEnvSlot(env, c);
+      graphEnvAccumulate(env.lastTemp, e.tMin, e.tMax, e.tFrom, env.lastTemp);
+      graphEnvAccumulate(env.lastHumi, e.hMin, e.hMax, e.hFrom, env.lastHumi);
+      if (mode == displayHoursIndex) graphRangeAddCol(e);
+    }
+  }
+
+  int16_t humi = recHumi(rec);
+  GraphEnvCol &e = graphEnvSlot(env, col);
+  graphEnvAccumulate(rec.temp, e.tMin, e.tMax, e.tFrom, env.lastTemp);
+  graphEnvAccumulate(humi, e.hMin, e.hMax, e.hFrom, env.lastHumi);
+  e.act |= recActuators(rec);
+  if (mode == displayHoursIndex) graphRangeAddCol(e);
+  env.lastCol = col;
+
+  if (rec.temp != INVALID_VALUE && humi != INVALID_VALUE) {
+    env.lastValidTs = rec.ts;
+  }
+}
+
+void graphEnvelopeAddAll(const LogRecord &rec) {
+  for (int m = 0; m < NUM_GRAPH_MODES; m++) graphEnvelopeAdd(m, rec);
+}
+
+void resetGraphEnvelopes() {
+  for (int m = 0; m < NUM_GRAPH_MODES; m++) {
+    GraphEnvelope &env = graphEnv[m];
+    env.lastCol = 0;
+    env.lastValidTs = 0;
+    env.lastTemp = env.lastHumi = INVALID_VALUE;
+    for (int i = 0; i < GRAPH_ENV_COLS; i++) {
+      env.cols[i].col = 0xFFFFFFFF;
+      env.cols[i].tMin = env.cols[i].tMax = env.cols[i].tFrom = INVALID_VALUE;
+      env.cols[i].hMin = env.cols[i].hMax = env.cols[i].hFrom = INVALID_VALUE;
+      env.cols[i].act = 0;
+    }
+  }
+  graphRangeClear();
+}
+
+// 현재 모드 엔벨로프로 min/max 덱 다시 채우기 (모드 변경, 엔벨로프 재계산 후) - O(그래프 폭)
+void rebuildGraphRange() {
+  graphRangeClear();
+  const GraphEnvelope &env = graphEnv[displayHoursIndex];
+  uint32_t first = env.lastCol >= GRAPH_ENV_COLS - 1 ? env.lastCol - (GRAPH_ENV_COLS - 1) : 0;
+  for (uint32_t c = first; c <= env.lastCol; c++) {
+    const GraphEnvCol &e = env.cols[c % GRAPH_ENV_COLS];
+    if (e.col == c) graphRangeAddCol(e);
+  }
+}
+
+// 표시 버퍼 전체로 다시 계산 (부팅 시 로드, 화면 회전으로 그래프 폭이 바뀐 경우)
+void rebuildGraphEnvelopes() {
+  resetGraphEnvelopes();
+  int record_count = isDisplayBufferFull ? DISPLAY_MAX_SAMPLES : displayLogIndex;
+  for (int i = 0; i < record_count; i++) {
+    int idx = (displayLogIndex - record_count + i + DISPLAY_MAX_SAMPLES) % DISPLAY_MAX_SAMPLES;
+    graphEnvelopeAddAll(displayLogBuf[idx]);
+  }
+  rebuildGraphRange();
+}
+
+
+
 void initDisplayBuffer() {
     for (int i = 0; i < DISPLAY_MAX_SAMPLES; i++) {
         displayLogBuf[i].ts = 0;
         displayLogBuf[i].temp = INVALID_VALUE;
-        displayLogBuf[i].humi = INVALID_VALUE;
+        displayLogBuf[i].humi_act = INVALID_VALUE;
     }
     displayLogIndex = 0;
     isDisplayBufferFull = false;
+    resetGraphEnvelopes();
 }
 
 void loadDataForDisplay() {
@@ -480,17 +841,19 @@ void loadDataForDisplay() {
     }
   }
   logFile.close();
+  rebuildGraphEnvelopes();
 }
 
-void pushToDisplayBuffer(float t, float h) {
+void pushToDisplayBuffer(float t, float h, uint8_t act) {
     if (!timeSynced) return;
 
     displayLogBuf[displayLogIndex].ts = time(nullptr);
     displayLogBuf[displayLogIndex].temp = (t != INVALID_VALUE && !isnan(t)) ? (int16_t)(t * 10.0f) : (int16_t)INVALID_VALUE;
-    displayLogBuf[displayLogIndex].humi = (h != INVALID_VALUE && !isnan(h)) ? (int16_t)(h * 10.0f) : (int16_t)INVALID_VALUE;
+    displayLogBuf[displayLogIndex].humi_act = packHumi((h != INVALID_VALUE && !isnan(h)) ? (int16_t)(h * 10.0f) : (int16_t)INVALID_VALUE, act);
     
     // Append to flash
     appendLogRecord(displayLogBuf[displayLogIndex]);
+    graphEnvelopeAddAll(displayLogBuf[displayLogIndex]);
 
     displayLogIndex = (displayLogIndex + 1) % DISPLAY_MAX_SAMPLES;
     if (displayLogIndex == 0) {
@@ -506,18 +869,70 @@ int stepToPWM(int step) { return map(step, 0, BRIGHTNESS_STEPS, 0, 255); }
 
 
 
-// readSensor 함수  SHT41, AHT20
-bool readSensor(float &temp, float &humi) {
+// 센서 읽기 함수  SHT41, AHT20 (트리거 / 수집)
+// [수정] 센서 측정을 트리거 / 수집 두 단계로 나눔 (변환 시간 동안 I2C 대기 루프에서 기다리지 않음)
+// 라이브러리의 measureHighPrecision() (약 9ms) / getEvent() (약 80ms) 는 변환이 끝날 때까지 delay 로 기다리므로
+// 명령만 보내고, 변환 시간이 지난 뒤 controlTask 스케줄러에서 결과를 읽음
+//   SHT41: 0xFD (고정밀) -> 8.3ms 후 6바이트 (온도 2 + CRC, 습도 2 + CRC), 변환 중에는 읽기 NACK
+//   AHT20: 0xAC 0x33 0x00 -> 80ms 후 7바이트 (상태, 데이터 5, CRC), 상태 bit7 = 변환 중
+#define SHT41_CMD_MEASURE_HIGH 0xFD
+#define SHT41_MEAS_MS          10
+#define AHT20_I2C_ADDR         0x38
+#define AHT20_MEAS_MS          80
+#define SENSOR_POLL_MS         5              // 아직 변환 중이면 다시 읽어볼 간격
+#define SENSOR_MAX_POLLS       10
+
+enum SensorResult { SR_OK, SR_BUSY, SR_ERROR };
+
+// Sensirion / Aosong 공통 CRC-8 (다항식 0x31, 초기값 0xFF)
+uint8_t sensorCrc8(const uint8_t* data, int len) {
+  uint8_t crc = 0xFF;
+  for (int i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+// 측정 시작 명령 (실패하면 false)
+bool sensorTrigger() {
   if (currentSensorType == 0) {
-    uint16_t error = sht4.measureHighPrecision(temp, humi);         // --- SHT41 읽기 ---
-    return (error == 0);
+    Wire.beginTransmission(SHT41_I2C_ADDR);
+    Wire.write(SHT41_CMD_MEASURE_HIGH);
+  } else {
+    Wire.beginTransmission(AHT20_I2C_ADDR);
+    Wire.write(0xAC); Wire.write(0x33); Wire.write(0x00);
+  }
+  return Wire.endTransmission() == 0;
+}
+
+uint32_t sensorConversionMs() {
+  return (currentSensorType == 0) ? SHT41_MEAS_MS : AHT20_MEAS_MS;
+}
+
+// 변환 결과 읽기 (SR_BUSY 면 조금 뒤에 다시)
+SensorResult sensorCollect(float &temp, float &humi) {
+  uint8_t buf[7];
+  if (currentSensorType == 0) {
+    if (Wire.requestFrom((uint8_t)SHT41_I2C_ADDR, (uint8_t)6) != 6) return SR_BUSY;   // --- SHT41 읽기 ---
+    for (int i = 0; i < 6; i++) buf[i] = Wire.read();
+    if (sensorCrc8(buf, 2) != buf[2] || sensorCrc8(buf + 3, 2) != buf[5]) return SR_ERROR;
+    uint16_t tTicks = (buf[0] << 8) | buf[1];
+    uint16_t hTicks = (buf[3] << 8) | buf[4];
+    temp = -45.0f + 175.0f * tTicks / 65535.0f;
+    humi = -6.0f + 125.0f * hTicks / 65535.0f;
+    return SR_OK;
   } 
   else {
-    sensors_event_t humEvent, tempEvent;                            // --- AHT20 읽기 ---
-    if (!aht20.getEvent(&humEvent, &tempEvent)) return false;
-    temp = tempEvent.temperature;
-    humi = humEvent.relative_humidity;
-    return true;
+    if (Wire.requestFrom((uint8_t)AHT20_I2C_ADDR, (uint8_t)7) != 7) return SR_ERROR;  // --- AHT20 읽기 ---
+    for (int i = 0; i < 7; i++) buf[i] = Wire.read();
+    if (buf[0] & 0x80) return SR_BUSY;
+    if (sensorCrc8(buf, 6) != buf[6]) return SR_ERROR;
+    uint32_t hRaw = ((uint32_t)buf[1] << 12) | ((uint32_t)buf[2] << 4) | (buf[3] >> 4);
+    uint32_t tRaw = ((uint32_t)(buf[3] & 0x0F) << 16) | ((uint32_t)buf[4] << 8) | buf[5];
+    humi = hRaw * 100.0f / 1048576.0f;
+    temp = tRaw * 200.0f / 1048576.0f - 50.0f;
+    return SR_OK;
   }
 }
 
@@ -527,7 +942,266 @@ bool readSensor(float &temp, float &humi) {
 float secondsPerPixel = 0;
 
 
+
+// =========================================
+// [추가] Retained 위젯 (상태가 바뀐 위젯만 다시 그리기)
+// =========================================
+// 각 위젯은 화면 사각형 하나를 소유하고, 마지막으로 그린 상태(해시)를 기억함
+// 매초 호출되더라도 상태가 같으면 아무것도 그리지 않음 -> SPI 전송량 감소, 깜빡임 제거
+enum UiWidgetId {
+  W_TIME, W_TEMP, W_HUMI,                                     // 상단 정보줄
+  W_FACE,                                                     // 얼굴 + 상태 문구
+  W_ICON_LED, W_ICON_HUMI, W_ICON_HEATER, W_ICON_FAN,         // 상태 아이콘
+  NUM_UI_WIDGETS
+};
+
+struct UiWidget {
+  const char* name;
+  int16_t x = 0, y = 0, w = 0, h = 0;           // 마지막으로 그린 사각형
+  uint32_t state = 0;             // 마지막으로 그린 상태 해시
+  bool valid = false;             // false 이면 상태와 무관하게 다시 그림
+  uint32_t repaints = 0, skips = 0;
+};
+
+UiWidget uiWidgets[NUM_UI_WIDGETS] = {
+  { "time" }, { "temp" }, { "humi" }, { "face" },
+  { "led" }, { "humidifier" }, { "heater" }, { "fan" },
+};
+
+// [추가] 프레임(loop 1회)별 LCD 전송 픽셀 수
+struct UiFrameStats {
+  uint32_t framePixels = 0;       // 현재 프레임 누적
+  uint32_t lastFramePixels = 0;   // 마지막으로 무언가 그린 프레임
+  uint32_t maxFramePixels = 0;
+  uint64_t totalPixels = 0;
+  uint32_t frames = 0;            // 무언가 그린 프레임 수
+  uint32_t graphFrameUs = 0, graphFrameMaxUs = 0;       // 그래프 프레임: 합성 시작 ~ 전송 완료
+  uint32_t graphBlockUs = 0, graphBlockMaxUs = 0;       // 그 중 loop() 를 막은 시간 (합성 + 스트립 복사 + DMA 대기)
+  uint32_t graphPushUs = 0, graphPushMaxUs = 0;         // 그 중 스프라이트 -> 전송 픽셀 변환 (4비트 팔레트 펼치기)
+  uint32_t overBudgetFrames = 0;                        // graphBlockUs > UI_FRAME_BUDGET_US 인 프레임 수
+};
+UiFrameStats uiStats = { 0 };
+
+
+
+#define WIDGET_HASH_INIT 2166136261UL
+
+uint32_t widgetHash(uint32_t h, uint32_t v) {
+  for (int i = 0; i < 4; i++) { h = (h ^ (v & 0xFF)) * 16777619UL; v >>= 8; }      // FNV-1a
+  return h;
+}
+
+uint32_t widgetHashStr(uint32_t h, const char* s) {
+  while (*s) h = (h ^ (uint8_t)*s++) * 16777619UL;
+  return h;
+}
+
+void uiCountPixels(uint32_t n) {
+  uiStats.framePixels += n;
+}
+
+// loop() 끝에서 호출
+void uiEndFrame() {
+  if (uiStats.framePixels == 0) return;
+  uiStats.lastFramePixels = uiStats.framePixels;
+  if (uiStats.framePixels > uiStats.maxFramePixels) uiStats.maxFramePixels = uiStats.framePixels;
+  uiStats.totalPixels += uiStats.framePixels;
+  uiStats.frames++;
+  uiStats.framePixels = 0;
+}
+
+
+
+// =========================================
+// [추가] 그래프 비동기 전송 (DMA, 스트립 더블 버퍼)
+// =========================================
+// pushSprite() 는 27MHz SPI 로 최대 65KB 를 보내는 동안 loop() 를 ~20ms 막음
+// -> 합성 버퍼(graphSprite)를 GRAPH_STRIP_ROWS 줄씩 전송 버퍼 2개에 번갈아 복사해 DMA 로 보냄
+//    한 스트립이 전송되는 동안 다음 스트립을 복사해 두고, 그 사이 loop() 의 다음 작업이 계속 실행됨
+// 다른 tft.* 그리기 전에는 tftSync() 로 진행 중인 DMA 를 끝내야 함 (같은 SPI 버스)
+#define GRAPH_STRIP_ROWS 10
+#define UI_FRAME_BUDGET_US 8000         // 그래프 프레임 1개가 loop() 를 막아도 되는 시간
+#define GRAPH_TAG_X 8                   // 모드 표시 (1H, 6H ...) 위치, 그래프 영역 기준
+#define GRAPH_TAG_Y 8
+
+struct GraphFlush {
+  bool dma = false;                     // initDMA() 성공 여부 (실패 시 pushSprite 로 대체)
+  bool active = false;                  // 이번 프레임 전송이 끝나지 않음
+  bool writing = false;                 // startWrite() 상태 (DMA 진행 중일 수 있음)
+  int nextRow = 0;                      // 다음에 복사할 줄
+  int readyRow = 0, readyRows = 0;      // 복사만 해 두고 아직 보내지 않은 스트립 (readyRows = 0 이면 없음)
+  uint8_t buf = 0;                      // 다음에 채울 전송 버퍼
+  unsigned long startUs = 0;            // 합성 시작 시각
+  uint32_t blockUs = 0;                 // 이번 프레임이 loop() 를 막은 시간
+  uint32_t pushUs = 0;                  // 그 중 스트립 복사/팔레트 펼치기 시간
+};
+GraphFlush graphFlush = { false };
+uint16_t* graphStripBuf[2] = { nullptr, nullptr };
+
+#if GRAPH_SPRITE_BPP == 4
+// 4비트 스프라이트 1바이트(픽셀 2개) -> RGB565 픽셀 2개 (SPI 바이트 순서), 스트립 복사할 때 펼침
+uint32_t graphPairLut[256];
+#endif
+
+void buildGraphPairLut() {
+#if GRAPH_SPRITE_BPP == 4
+  uint16_t swapped[16] = { 0 };
+  for (int i = 0; i < NUM_GRAPH_COLORS; i++) swapped[i] = (graphPalette[i] >> 8) | (graphPalette[i] << 8);
+  for (int b = 0; b < 256; b++) {
+    graphPairLut[b] = swapped[b >> 4] | ((uint32_t)swapped[b & 0x0F] << 16);   // 짝수 x = 상위 니블 = 앞쪽 주소
+  }
+#endif
+}
+TFT_eSprite graphTagSprite = TFT_eSprite(&tft);       // 모드 표시: 스크롤되지 않도록 전송할 때 스트립 위에 덮어씀
+
+void recordGraphFrame(uint32_t frameUs, uint32_t blockUs, uint32_t pushUs) {
+  uiStats.graphPushUs = pushUs;
+  if (pushUs > uiStats.graphPushMaxUs) uiStats.graphPushMaxUs = pushUs;
+  uiStats.graphFrameUs = frameUs;
+  if (frameUs > uiStats.graphFrameMaxUs) uiStats.graphFrameMaxUs = frameUs;
+  uiStats.graphBlockUs = blockUs;
+  if (blockUs > uiStats.graphBlockMaxUs) uiStats.graphBlockMaxUs = blockUs;
+  if (blockUs > UI_FRAME_BUDGET_US) uiStats.overBudgetFrames++;
+}
+
+// 진행 중인 DMA 가 끝날 때까지 기다리고 SPI 버스를 놓음 (직접 tft.* 로 그리기 전에 호출)
+void tftSync() {
+  if (!graphFlush.writing) return;
+  unsigned long t0 = micros();
+  tft.dmaWait();
+  tft.endWrite();
+  graphFlush.writing = false;
+  graphFlush.blockUs += micros() - t0;
+}
+
+// 전송 중이던 프레임 중단 (정보창처럼 그래프 위를 덮는 화면을 그리기 전, 버퍼 재할당 전)
+void graphFlushCancel() {
+  tftSync();
+  graphFlush.active = false;
+}
+
+// 합성 버퍼의 다음 GRAPH_STRIP_ROWS 줄을 전송 버퍼에 복사 (+ 모드 표시 덮어쓰기)
+void prepareGraphStrip() {
+  int rows = min(GRAPH_STRIP_ROWS, layout->graph_h - graphFlush.nextRow);
+  uint16_t* strip = graphStripBuf[graphFlush.buf];
+  unsigned long t0 = micros();
+#if GRAPH_SPRITE_BPP == 4
+  const uint8_t* src = (const uint8_t*)graphSprite.getPointer() + graphFlush.nextRow * layout->graph_w / 2;
+  uint32_t* dst = (uint32_t*)strip;
+  for (int i = 0, n = rows * layout->graph_w / 2; i < n; i++) dst[i] = graphPairLut[src[i]];
+#else
+  const uint16_t* src = (const uint16_t*)graphSprite.getPointer() + graphFlush.nextRow * layout->graph_w;
+  memcpy(strip, src, rows * layout->graph_w * sizeof(uint16_t));
+#endif
+
+  int tw = graphTagSprite.width(), th = graphTagSprite.height();
+  const uint16_t* tag = (const uint16_t*)graphTagSprite.getPointer();
+  int y0 = max(graphFlush.nextRow, GRAPH_TAG_Y);
+  int y1 = min(graphFlush.nextRow + rows, GRAPH_TAG_Y + th);
+  for (int y = y0; y < y1; y++) {
+    memcpy(strip + (y - graphFlush.nextRow) * layout->graph_w + GRAPH_TAG_X, tag + (y - GRAPH_TAG_Y) * tw, tw * sizeof(uint16_t));
+  }
+  graphFlush.pushUs += micros() - t0;
+
+  graphFlush.readyRow = graphFlush.nextRow;
+  graphFlush.readyRows = rows;
+  graphFlush.nextRow += rows;
+}
+
+// loop() 에서 매번 호출: DMA 가 비어 있으면 준비된 스트립을 보내고, 전송되는 동안 다음 스트립을 복사
+void graphFlushPump() {
+  if (!graphFlush.active) return;
+  if (graphFlush.writing && tft.dmaBusy()) return;            // 전송 중 -> 다음 loop 에서 다시
+
+  unsigned long t0 = micros();
+
+  if (graphFlush.readyRows == 0) {
+    if (graphFlush.nextRow >= layout->graph_h) {                 // 마지막 스트립까지 전송 완료
+      if (graphFlush.writing) tft.endWrite();
+      graphFlush.writing = false;
+      graphFlush.active = false;
+      graphFlush.blockUs += micros() - t0;
+      recordGraphFrame(micros() - graphFlush.startUs, graphFlush.blockUs, graphFlush.pushUs);
+      return;
+    }
+    prepareGraphStrip();
+  }
+
+  if (!graphFlush.writing) { tft.startWrite(); graphFlush.writing = true; }
+  bool swap = tft.getSwapBytes();
+  tft.setSwapBytes(false);                                      // 스프라이트 버퍼는 이미 SPI 바이트 순서
+  tft.pushImageDMA(layout->graph_x, layout->graph_y + graphFlush.readyRow, layout->graph_w, graphFlush.readyRows, graphStripBuf[graphFlush.buf]);
+  tft.setSwapBytes(swap);
+  graphFlush.buf ^= 1;
+  graphFlush.readyRows = 0;
+
+  if (graphFlush.nextRow < layout->graph_h) prepareGraphStrip(); // DMA 가 도는 동안 다음 스트립 준비
+
+  graphFlush.blockUs += micros() - t0;
+}
+
+// 합성이 끝난 프레임 전송 시작 (전송 중이던 프레임은 처음부터 다시)
+// [수정] composeUs: 합성이 loop() 를 막은 시간 (전체 다시 그리기를 여러 loop 에 나눠 그렸으면 그 합)
+void graphFlushBegin(unsigned long composeStartUs, uint32_t composeUs) {
+  uiCountPixels((uint32_t)layout->graph_w * layout->graph_h);
+
+  if (!graphFlush.dma || !graphStripBuf[0] || !graphStripBuf[1]) {
+    unsigned long t0 = micros();
+    graphSprite.pushSprite(layout->graph_x, layout->graph_y);     // DMA 를 못 쓰면 기존처럼 한 번에 전송 (4비트는 팔레트로 펼쳐서)
+    graphTagSprite.pushSprite(layout->graph_x + GRAPH_TAG_X, layout->graph_y + GRAPH_TAG_Y);
+    uint32_t pushUs = micros() - t0;
+    recordGraphFrame(micros() - composeStartUs, composeUs + pushUs, pushUs);
+    return;
+  }
+
+  graphFlush.active = true;
+  graphFlush.nextRow = 0;
+  graphFlush.readyRows = 0;
+  graphFlush.startUs = composeStartUs;
+  graphFlush.blockUs = composeUs;                               // 합성 시간
+  graphFlush.pushUs = 0;
+  graphFlushPump();
+}
+
+// 전송 버퍼 할당 (그래프 폭이 바뀌면 다시)
+void allocGraphStrips() {
+  graphFlushCancel();
+  for (int i = 0; i < 2; i++) {
+    if (graphStripBuf[i]) heap_caps_free(graphStripBuf[i]);
+    graphStripBuf[i] = (uint16_t*)heap_caps_malloc(GRAPH_STRIP_ROWS * layout->graph_w * sizeof(uint16_t), MALLOC_CAP_DMA);
+  }
+}
+
+
+
+// 상태나 위치가 바뀌었으면 true (호출한 쪽이 사각형을 지우고 다시 그림), 같으면 false
+bool widgetBegin(int id, int x, int y, int w, int h, uint32_t state) {
+  UiWidget &wd = uiWidgets[id];
+  if (wd.valid && wd.state == state && wd.x == x && wd.y == y && wd.w == w && wd.h == h) {
+    wd.skips++;
+    return false;
+  }
+  tftSync();
+  wd.x = x; wd.y = y; wd.w = w; wd.h = h;
+  wd.state = state;
+  wd.valid = true;
+  wd.repaints++;
+  uiCountPixels((uint32_t)w * h);
+  return true;
+}
+
+void invalidateWidget(int id) {
+  uiWidgets[id].valid = false;
+}
+
+// 화면 전체를 지운 뒤 (회전, 정보창 닫기) 호출
+void invalidateWidgets() {
+  for (int i = 0; i < NUM_UI_WIDGETS; i++) uiWidgets[i].valid = false;
+}
+
+
 void drawTitle() {
+  tftSync();
   // 1. 배경 지우기
   // tft.fillScreen(BG_COLOR); // (화면 전체 지우기는 loop 로직에 따라 깜빡임 유발 가능하므로 주석 유지 or 필요시 사용)
   
@@ -545,7 +1219,7 @@ void drawTitle() {
   // FreeFont는 기준점(Baseline)이 달라서 y좌표를 조금 더 내려야 중앙에 옵니다.
   // TITLE_Y(5) + 20 정도가 적당합니다.
   tft.setCursor(5, TITLE_Y + 20);
-  tft.print(headlineText.c_str());
+  tft.print(layout->headline);
   
   // 4. 하단 라인 그리기
   tft.drawFastHLine(0, TITLE_Y + TITLE_H - 1, tft.width(), TFT_DARKGREY);
@@ -557,92 +1231,175 @@ void drawTitle() {
 
 
 
-void drawTimeTempHumi(float t, float h, bool timeAvailable) {
-  // 1. 기존 영역 지우기 (높이를 20 -> 24로 살짝 키워 여유를 줌)
-  //tft.fillRect(0, INFO_Y, 240, 24, BG_COLOR);
-  
-  if (screenRotation == 0) {                              // 세로모드
-      tft.fillRect(0, INFO_Y, 240, 24, BG_COLOR); 
-  } else {                                                // 가로모드
-      tft.fillRect(0, INFO_Y, 320, 24, BG_COLOR);
+// =========================================
+// [추가] 정보줄 글리프 캐시 (FreeSansBold9pt7b)
+// =========================================
+// 숫자와 '.', 'C', '%', ':', ' ', '-' 를 부팅 시 1비트 스프라이트(글자 폭 x 정보줄 높이)로 한 번만 그려 두고,
+// 시계/온도/습도는 이전에 그린 문자열과 비교해 바뀐 글자 칸만 pushSprite 로 찍음 (매번 FreeFont 래스터라이즈 안 함)
+#define GLYPH_CHARS "0123456789.C%: -"
+#define GLYPH_CELL_H 24                     // 정보줄 높이
+#define GLYPH_BASELINE 14                   // drawInfoText 와 같은 기준선 (INFO_Y + 14)
+#define READOUT_MAX 12
+
+struct GlyphCell {
+  char ch;
+  uint8_t adv;                              // xAdvance = 칸 폭
+  TFT_eSprite* spr;                         // 1비트, 배경 포함 (찍으면 이전 글자를 덮어씀)
+};
+GlyphCell glyphCache[sizeof(GLYPH_CHARS) - 1];
+bool glyphCacheReady = false;
+
+struct GlyphReadout {
+  char text[READOUT_MAX];                   // 마지막으로 그린 문자열
+  int16_t endX;                             // 마지막 글자 칸 끝
+  uint16_t color;
+  bool valid;
+};
+GlyphReadout glyphReadouts[W_HUMI + 1];     // W_TIME, W_TEMP, W_HUMI
+
+void initGlyphCache() {
+  const GFXfont* font = &FreeSansBold9pt7b;
+  const char* chars = GLYPH_CHARS;
+  for (int i = 0; chars[i]; i++) {
+    GlyphCell &g = glyphCache[i];
+    char str[2] = { chars[i], 0 };
+    g.ch = chars[i];
+    g.adv = font->glyph[chars[i] - font->first].xAdvance;
+    g.spr = new TFT_eSprite(&tft);
+    g.spr->setColorDepth(1);
+    if (!g.spr->createSprite(g.adv, GLYPH_CELL_H)) return;     // 메모리 부족 -> 캐시 없이 기존 방식으로 그림
+    g.spr->fillSprite(0);
+    g.spr->setFreeFont(font);
+    g.spr->setTextColor(1);
+    g.spr->setCursor(0, GLYPH_BASELINE);
+    g.spr->print(str);
   }
+  glyphCacheReady = true;
+}
+
+const GlyphCell* findGlyph(char c) {
+  for (size_t i = 0; i < sizeof(glyphCache) / sizeof(glyphCache[0]); i++) {
+    if (glyphCache[i].ch == c) return &glyphCache[i];
+  }
+  return nullptr;
+}
+
+// 글리프 캐시로 정보줄 텍스트 그리기: 바뀐 글자 칸만 찍고, 문자열이 짧아졌으면 남은 꼬리만 지움
+// 캐시에 없는 글자가 있으면 false (호출한 쪽에서 drawInfoText 로 대체)
+bool drawInfoGlyphs(int id, int x, int w, int textX, const char* text, uint16_t color) {
+  if (!glyphCacheReady) return false;
+  size_t n = strlen(text);
+  if (n >= READOUT_MAX) return false;
+  for (size_t i = 0; i < n; i++) if (!findGlyph(text[i])) return false;
+
+  UiWidget &wd = uiWidgets[id];
+  GlyphReadout &r = glyphReadouts[id];
+  uint32_t state = widgetHash(widgetHashStr(WIDGET_HASH_INIT, text), color);
+  bool full = !wd.valid || !r.valid || r.color != color
+           || wd.x != x || wd.y != INFO_Y || wd.w != w || wd.h != GLYPH_CELL_H;
+  if (!full && wd.state == state) { wd.skips++; return true; }
+
+  tftSync();
+  if (full) {
+    tft.fillRect(x, INFO_Y, w, GLYPH_CELL_H, BG_COLOR);
+    uiCountPixels((uint32_t)w * GLYPH_CELL_H);
+    r.text[0] = 0;
+    r.endX = textX;
+  }
+
+  size_t oldLen = strlen(r.text);
+  int cx = textX;
+  bool shifted = false;                     // 앞 글자 폭이 달라져 이후 칸 위치가 바뀜
+  for (size_t i = 0; i < n; i++) {
+    const GlyphCell* g = findGlyph(text[i]);
+    if ((shifted || i >= oldLen || r.text[i] != text[i]) && cx + g->adv <= x + w) {
+      g->spr->setBitmapColor(color, BG_COLOR);
+      g->spr->pushSprite(cx, INFO_Y);
+      uiCountPixels((uint32_t)g->adv * GLYPH_CELL_H);
+    }
+    if (i >= oldLen || findGlyph(r.text[i])->adv != g->adv) shifted = true;
+    cx += g->adv;
+  }
+  if (cx < r.endX) {
+    int ex = min((int)r.endX, x + w);
+    tft.fillRect(cx, INFO_Y, ex - cx, GLYPH_CELL_H, BG_COLOR);
+    uiCountPixels((uint32_t)(ex - cx) * GLYPH_CELL_H);
+  }
+
+  strcpy(r.text, text);
+  r.endX = cx;
+  r.color = color;
+  r.valid = true;
+  wd.x = x; wd.y = INFO_Y; wd.w = w; wd.h = GLYPH_CELL_H;
+  wd.state = state;
+  wd.valid = true;
+  wd.repaints++;
+  return true;
+}
+
+
+
+// [추가] 정보줄 텍스트 위젯: 내용/색이 바뀐 경우에만 자기 칸을 지우고 다시 씀
+void drawInfoText(int id, int x, int w, int textX, const char* text, uint16_t color) {
+  if (!widgetBegin(id, x, INFO_Y, w, 24, widgetHash(widgetHashStr(WIDGET_HASH_INIT, text), color))) return;
+  if (id <= W_HUMI) glyphReadouts[id].valid = false;             // 글리프 캐시 경로는 다음에 전체 다시 그림
+
+  tft.fillRect(x, INFO_Y, w, 24, BG_COLOR);
+  tft.setCursor(textX, INFO_Y + 14);                              // FreeFont는 y좌표가 글자 밑부분 (18보다 14가 적당함)
+  tft.setTextColor(color, BG_COLOR);
+  tft.print(text);
+}
+
+// 시계/온도/습도: 글리프 캐시 우선, 캐시에 없는 글자(nan 등)는 FreeFont 로
+void drawReadout(int id, int x, int w, int textX, const char* text, uint16_t color) {
+  if (!drawInfoGlyphs(id, x, w, textX, text, color)) drawInfoText(id, x, w, textX, text, color);
+}
 
 
+
+// [수정] 시간/온도/습도를 각각 위젯으로 분리 -> 바뀐 칸만 다시 그림 (시간은 1분에 한 번)
+template <int ROT>
+void drawTimeTempHumiFor(float t, float h) {
+  constexpr const ScreenLayout &L = SCREEN_LAYOUTS[ROT];
   struct tm timeinfo;
   bool isTimeValid = getLocalTime(&timeinfo, 0) && timeinfo.tm_year > (2020 - 1900);
 
-  // 2. 9포인트 폰트 적용
+  // 9포인트 폰트 적용
   tft.setFreeFont(&FreeSansBold9pt7b);
   tft.setTextSize(1); // FreeFont는 기본 크기 사용
 
-  // 3. 텍스트 기준선(Baseline) 보정
-  // FreeFont는 y좌표가 글자 밑부분이므로, 기존보다 아래로 내려야 합니다.
-  // INFO_Y(40) + 18 정도가 적당합니다.
-  int textY = INFO_Y + 14;           // 18보다 14가 적당함
+  // 칸 배치: 세로모드 [0,95) [95,170) [170,240), 가로모드 [140,200) [200,260) [260,320)
+  const int xTime = L.info_x_time, xTemp = L.info_x_temp, xHumi = L.info_x_humi, xEnd = L.info_x_end;
+  const int textXTime = L.info_text_x_time;
+
+  char buf[24];
 
   if (isTimeValid) {
     if (!timeSynced) { timeSynced = true; lastNtpSync = millis(); }
 
-    if (screenRotation == 0) {            // 세로모드
-        // 시간 표시 (파란색)
-        tft.setCursor(5, textY);
-        tft.setTextColor(TFT_BLUE, BG_COLOR);
-        //tft.printf("%02d:%02d:%02d", timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
-        tft.printf("%02d:%02d", timeinfo.tm_hour, timeinfo.tm_min);
-        
-        // 온도 표시 (노란색)
-        tft.setCursor(95, textY); // x좌표 조정 (시간 길이 고려)
-        tft.setTextColor(TFT_YELLOW, BG_COLOR);
-        tft.printf("%4.1fC", t);
-        
-        // 습도 표시 (초록색)
-        tft.setCursor(170, textY); // x좌표 조정
-        tft.setTextColor(TFT_GREEN, BG_COLOR);
-        tft.printf("%4.1f%%", h);
-
-    } else {                                  // 가로모드
-        int x= 140;                           // X축 좌표 보정
-        // 시간 표시 (파란색)
-        tft.setCursor(x + 5, textY);
-        tft.setTextColor(TFT_BLUE, BG_COLOR);
-        //tft.printf("%02d:%02d:%02d", timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
-        tft.printf("%02d:%02d", timeinfo.tm_hour, timeinfo.tm_min);
-        
-        // 온도 표시 (노란색)
-        tft.setCursor(x + 60, textY); // x좌표 조정 (시간 길이 고려)
-        tft.setTextColor(TFT_YELLOW, BG_COLOR);
-        tft.printf("%4.1fC", t);
-        
-        // 습도 표시 (초록색)
-        tft.setCursor(x + 120, textY); // x좌표 조정
-        tft.setTextColor(TFT_GREEN, BG_COLOR);
-        tft.printf("%4.1f%%", h);
-    }
+    // 시간 표시 (파란색)
+    snprintf(buf, sizeof(buf), "%02d:%02d", timeinfo.tm_hour, timeinfo.tm_min);
+    drawReadout(W_TIME, xTime, xTemp - xTime, textXTime, buf, TFT_BLUE);
+
+    // 온도 표시 (노란색)
+    snprintf(buf, sizeof(buf), "%4.1fC", t);
+    drawReadout(W_TEMP, xTemp, xHumi - xTemp, xTemp, buf, TFT_YELLOW);
+
+    // 습도 표시 (초록색)
+    snprintf(buf, sizeof(buf), "%4.1f%%", h);
+    drawReadout(W_HUMI, xHumi, xEnd - xHumi, xHumi, buf, TFT_GREEN);
 
-  //tft.setFreeFont(NULL);
   } else {
     
     if (timeSynced) timeSynced = false;            // 시간이 유효하지 않을 때 (WiFi 접속 중 등)
 
-    if (screenRotation == 0) {                     // 세로모드
-        tft.setCursor(5, textY);
-        tft.setTextColor(TFT_ORANGE, BG_COLOR);
-
-        if (WiFi.status() != WL_CONNECTED) tft.print("WiFi Connecting...");
-        else tft.print("NTP Syncing...");
-
-    } else {                                      // 가로모드
-        int x= 140;                               // X축 좌표 보정
-        tft.setCursor(x + 5, textY);
-        tft.setTextColor(TFT_ORANGE, BG_COLOR);
-
-        if (WiFi.status() != WL_CONNECTED) tft.print("WiFi Connecting...");
-        else tft.print("NTP Syncing...");
-    }
-    tft.setCursor(5, textY);
-    //tft.print("                   ");
+    // 안내 문구는 정보줄 전체를 사용 -> 온도/습도 칸은 다음에 다시 그리도록 무효화
+    const char* msg = (WiFi.status() != WL_CONNECTED) ? "WiFi Connecting..." : "NTP Syncing...";
+    drawInfoText(W_TIME, xTime, xEnd - xTime, textXTime, msg, TFT_ORANGE);
+    invalidateWidget(W_TEMP);
+    invalidateWidget(W_HUMI);
   }
-  // 4. 폰트 복구
+  // 폰트 복구
   tft.setFreeFont(NULL);
 }
 
@@ -652,20 +1409,48 @@ void drawTimeTempHumi(float t, float h, bool timeAvailable) {
 
 
 
+// [수정] 시간축: 절대 컬럼 번호 기반 (컬럼 = ts * 그래프폭 / 표시구간초)
+// 같은 시각은 항상 같은 컬럼에 매핑되므로 스크롤(증분) 렌더링과 전체 렌더링 결과가 일치함
+// 세로 격자/라벨은 현지시각 기준 gridStepSec 배수에 정렬 (1H:10분, 6H:1시간, 12H:2시간, 24H:4시간)
 struct TimeAxisState {
-  float totalMin, minPerPx, labelStepMin;
-  int nowMin, anchorMin, anchorX;
+  uint32_t windowSec;         // 표시 구간 (초)
+  uint32_t gridStepSec;       // 세로 격자/라벨 간격 (초)
+  uint32_t rightCol;          // 그래프 오른쪽 끝(x = w-1)의 절대 컬럼 번호
 };
 
+#define LOCAL_TZ_OFFSET_SEC (gmtOffset_sec + daylightOffset_sec)
+
+uint32_t graphColumnOf(uint32_t ts) {
+  return graphColumnFor(ts, graphWindowSec(displayHoursIndex));
+}
+
+// 컬럼 c 에 매핑되는 첫 시각 (ceil(c * window / w)), col = q * w + r 로 나눠 32비트로 계산
+uint32_t graphColumnStartTsFor(uint32_t col, uint32_t windowSec) {
+  uint32_t q = col / layout->graph_w;
+  uint32_t r = col % layout->graph_w;
+  return q * windowSec + (r * windowSec + layout->graph_w - 1) / layout->graph_w;
+}
+
+uint32_t graphColumnStartTs(uint32_t col) {
+  return graphColumnStartTsFor(col, graphWindowSec(displayHoursIndex));
+}
+
+// 절대 컬럼 -> 스프라이트 x 좌표 (오른쪽 끝 = w-1, 범위 밖이면 음수 또는 w 이상)
+int graphColumnX(const TimeAxisState &axis, uint32_t col) {
+  if (col > axis.rightCol) return layout->graph_w;
+  uint32_t back = axis.rightCol - col;
+  if (back >= (uint32_t)layout->graph_w) return -1;
+  return layout->graph_w - 1 - (int)back;
+}
+
+uint32_t graphLeftCol(const TimeAxisState &axis) {
+  return (axis.rightCol >= (uint32_t)(layout->graph_w - 1)) ? axis.rightCol - (layout->graph_w - 1) : 0;
+}
+
 void computeTimeAxis(TimeAxisState &axis) {
-  axis.totalMin = displayHours * 60.0f;
-  axis.minPerPx = axis.totalMin / layout_graph_w;
-  axis.labelStepMin = axis.totalMin / (layout_num_labels - 1);
-  time_t nowSec; time(&nowSec); struct tm timeinfo; localtime_r(&nowSec, &timeinfo);
-  axis.nowMin = timeinfo.tm_hour * 60 + timeinfo.tm_min;
-  axis.anchorMin = (axis.nowMin / 10) * 10;
-  float anchorOffsetPx = (axis.nowMin - axis.anchorMin) / axis.minPerPx;
-  axis.anchorX = layout_graph_x + layout_graph_w - (int)(anchorOffsetPx + 0.5f);
+  axis.windowSec = (uint32_t)displayHours * 3600UL;
+  axis.gridStepSec = axis.windowSec / (layout->num_labels - 1);
+  axis.rightCol = graphColumnOf((uint32_t)time(nullptr));
 }
 
 
@@ -673,38 +1458,41 @@ void computeTimeAxis(TimeAxisState &axis) {
 
 // --------------------------------------------------------- New UI Functions -----------------------------------------------------------------
 
-void drawConditionFace() {    
+template <int ROT>
+void drawConditionFaceFor() {
+    constexpr const ScreenLayout &L = SCREEN_LAYOUTS[ROT];
     // -값일 경우 그리기 생략 
-    if (layout_face_y < 0) return; 
+    if (L.face_y < 0) return; 
 
-    int centerX = (tft.width() - TFT_WIDTH_OFFSET) / 2;
+    const int centerX = L.face_cx;              // 세로: (240 - TFT_WIDTH_OFFSET) / 2, 가로: 40
 
     // --- 1. 상태 결정 로직 (기존 유지) ---
     uint16_t face_color;
     enum { SHAPE_SMILE, SHAPE_STRAIGHT, SHAPE_FROWN } mouth_shape;
     String temp_status, humi_status; 
+    const CageState st = readState();
 
     // Determine Temperature status
-    if (isnan(lastTemp)) temp_status = "Err";
-    else if (lastTemp < tempMin) temp_status = "Low";
-    else if (lastTemp > tempMax) temp_status = "High";
+    if (isnan(st.temp)) temp_status = "Err";
+    else if (st.temp < tempMin) temp_status = "Low";
+    else if (st.temp > tempMax) temp_status = "High";
     else temp_status = "Good";
 
     // Determine Humidity status
-    if (isnan(lastHumi)) humi_status = "Err";
-    else if (lastHumi < humiMin) humi_status = "Low";
-    else if (lastHumi > humiMax) humi_status = "High";
+    if (isnan(st.humi)) humi_status = "Err";
+    else if (st.humi < humiMin) humi_status = "Low";
+    else if (st.humi > humiMax) humi_status = "High";
     else humi_status = "Good";
 
     // 1a. Determine color
-    if (isnan(lastTemp)) face_color = TFT_RED;
-    else if (lastTemp < tempMin) face_color = TFT_BLUE;
-    else if (lastTemp > tempMax) face_color = TFT_RED;
+    if (isnan(st.temp)) face_color = TFT_RED;
+    else if (st.temp < tempMin) face_color = TFT_BLUE;
+    else if (st.temp > tempMax) face_color = TFT_RED;
     else face_color = TFT_YELLOW;
 
     // 1b. Determine mouth shape
-    bool temp_ok = !isnan(lastTemp) && (lastTemp >= tempMin && lastTemp <= tempMax);
-    bool humi_ok = !isnan(lastHumi) && (lastHumi >= humiMin && lastHumi <= humiMax);
+    bool temp_ok = !isnan(st.temp) && (st.temp >= tempMin && st.temp <= tempMax);
+    bool humi_ok = !isnan(st.humi) && (st.humi >= humiMin && st.humi <= humiMax);
 
     if (temp_ok && humi_ok) mouth_shape = SHAPE_SMILE;                                  // T:Good, H:Good -> Smile (U)
     else if (temp_ok != humi_ok) mouth_shape = SHAPE_STRAIGHT;                          // One is good, one is bad -> Straight (-)
@@ -714,75 +1502,39 @@ void drawConditionFace() {
     // --- 2. Draw the Face ---
     int face_r = 28; // Large, round face
 
+    // [추가] 얼굴색/입모양/상태 문구가 그대로면 다시 그리지 않음
+    uint32_t state = widgetHash(widgetHash(WIDGET_HASH_INIT, face_color), mouth_shape);
+    state = widgetHashStr(widgetHashStr(state, temp_status.c_str()), humi_status.c_str());
+
     // Clear area for the new larger face
-    // layout_face_y 변수 사용
-
-    if (screenRotation == 0) {         // --- 세로 모드 (Portrait)
-        tft.fillRect(0, layout_face_y - face_r, tft.width(), face_r * 2, BG_COLOR);
-
-        // Head
-        tft.fillCircle(centerX, layout_face_y, face_r, face_color);
-        tft.drawCircle(centerX, layout_face_y, face_r, TFT_BLACK);
-
-        // Eyes
-        tft.fillEllipse(centerX - 10, layout_face_y - 8, 4, 8, TFT_BLACK); // Left eye
-        tft.fillEllipse(centerX + 10, layout_face_y - 8, 4, 8, TFT_BLACK); // Right eye
-
-        // Mouth
-        if (mouth_shape == SHAPE_SMILE) { // U shape (inverted Y)
-            // Draw a thick parabolic smile
-            for (int i = -12; i <= 12; i++) {
-                int x = centerX + i;
-                int y = layout_face_y + 18 - (int)(i * i * 0.05);
-                tft.drawFastVLine(x, y, 2, TFT_BLACK);
-            }
-        } else if (mouth_shape == SHAPE_STRAIGHT) { // - shape
-            tft.fillRect(centerX - 12, layout_face_y + 13, 25, 3, TFT_BLACK);
-        }
-        else { // SHAPE_FROWN (∩ shape) (inverted Y)
-            // Draw a thick parabolic frown
-            for (int i = -12; i <= 12; i++) {
-                int x = centerX + i;
-                int y = layout_face_y + 10 + (int)(i * i * 0.05);
-                tft.drawFastVLine(x, y, 2, TFT_BLACK);
-            }
+    if (!widgetBegin(W_FACE, L.face_clear_x, L.face_y - face_r, L.face_clear_w, face_r * 2, state)) return;
+    tft.fillRect(L.face_clear_x, L.face_y - face_r, L.face_clear_w, face_r * 2, BG_COLOR);
+
+    // Head
+    tft.fillCircle(centerX, L.face_y, face_r, face_color);
+    tft.drawCircle(centerX, L.face_y, face_r, TFT_BLACK);
+
+    // Eyes
+    tft.fillEllipse(centerX - 10, L.face_y - 8, 4, 8, TFT_BLACK); // Left eye
+    tft.fillEllipse(centerX + 10, L.face_y - 8, 4, 8, TFT_BLACK); // Right eye
+
+    // Mouth
+    if (mouth_shape == SHAPE_SMILE) { // U shape (inverted Y)
+        // Draw a thick parabolic smile
+        for (int i = -12; i <= 12; i++) {
+            int x = centerX + i;
+            int y = L.face_y + 18 - (int)(i * i * 0.05);
+            tft.drawFastVLine(x, y, 2, TFT_BLACK);
         }
+    } else if (mouth_shape == SHAPE_STRAIGHT) { // - shape
+        tft.fillRect(centerX - 12, L.face_y + 13, 25, 3, TFT_BLACK);
     }
-    else {      // 가로화면
-        //centerX += 130;                     // 기준 좌표를 우측으로 100px 이동
-        centerX = 40;                         // 기준 좌표를 우측으로 10px  이동
-
-
-
-        //tft.fillRect(0, layout_face_y - face_r, tft.width(), face_r * 2, BG_COLOR);
-        tft.fillRect(centerX - face_r - 10, layout_face_y - face_r, (face_r * 2) + 20, face_r * 2, BG_COLOR);
-
-        // Head
-        tft.fillCircle(centerX, layout_face_y, face_r, face_color);
-        tft.drawCircle(centerX, layout_face_y, face_r, TFT_BLACK);
-
-        // Eyes
-        tft.fillEllipse(centerX - 10, layout_face_y - 8, 4, 8, TFT_BLACK); // Left eye
-        tft.fillEllipse(centerX + 10, layout_face_y - 8, 4, 8, TFT_BLACK); // Right eye
-
-        // Mouth
-        if (mouth_shape == SHAPE_SMILE) { // U shape (inverted Y)
-            // Draw a thick parabolic smile
-            for (int i = -12; i <= 12; i++) {
-                int x = centerX + i;
-                int y = layout_face_y + 18 - (int)(i * i * 0.05);
-                tft.drawFastVLine(x, y, 2, TFT_BLACK);
-            }
-        } else if (mouth_shape == SHAPE_STRAIGHT) { // - shape
-            tft.fillRect(centerX - 12, layout_face_y + 13, 25, 3, TFT_BLACK);
-        }
-        else { // SHAPE_FROWN (∩ shape) (inverted Y)
-            // Draw a thick parabolic frown
-            for (int i = -12; i <= 12; i++) {
-                int x = centerX + i;
-                int y = layout_face_y + 10 + (int)(i * i * 0.05);
-                tft.drawFastVLine(x, y, 2, TFT_BLACK);
-            }
+    else { // SHAPE_FROWN (∩ shape) (inverted Y)
+        // Draw a thick parabolic frown
+        for (int i = -12; i <= 12; i++) {
+            int x = centerX + i;
+            int y = L.face_y + 10 + (int)(i * i * 0.05);
+            tft.drawFastVLine(x, y, 2, TFT_BLACK);
         }
     }
 
@@ -791,19 +1543,14 @@ void drawConditionFace() {
     tft.setTextDatum(TL_DATUM);                 // Top-Left datum
     tft.setTextSize(1);
     tft.setTextColor(TFT_SILVER, BG_COLOR);
-    
 
-    if (screenRotation == 0) {                                                        // --- 세로 모드 (Portrait)
-      int text_x = 5;
-      tft.drawString("Temp: " + temp_status, text_x, layout_face_y - 15);
-      tft.drawString("Humi: " + humi_status, text_x, layout_face_y + 5);
-    } else {                                                                          // --- 가로 모드 (Landscape)
-      int text_x = 5;
-      int offset_x = 70;
-      tft.drawString("Temp: " + temp_status, text_x + offset_x - 2, layout_face_y - 20 - 18 + 4+10);
-      tft.drawString("Humi: " + humi_status, text_x + offset_x - 2, layout_face_y - 10 - 18 + 4+10);
+    if (L.status_clear_w > 0) {
+      // 상태 문구 칸이 얼굴 사각형 바깥이면 따로 지움 (문구 길이가 줄어들 때 잔상 방지)
+      tft.fillRect(L.status_x, L.face_y + L.status_dy1, L.status_clear_w, 18, BG_COLOR);
+      uiCountPixels(L.status_clear_w * 18);
     }
-
+    tft.drawString("Temp: " + temp_status, L.status_x, L.face_y + L.status_dy1);
+    tft.drawString("Humi: " + humi_status, L.status_x, L.face_y + L.status_dy2);
 }
 
 
@@ -812,68 +1559,107 @@ void drawConditionFace() {
 
 
 // ----------------------------------- 바람개비 아이콘(회전동작) -------------------------------------------
-// 애니메이션을 위한 변수 (루프 밖이나 클래스 멤버로 선언)
-float fan_angle = 0; 
+// [수정] 날개 꼭짓점을 미리 계산한 표 사용 (매 프레임 cos/sin 8번 호출 제거)
+// 날개 4개가 90도 간격이라 1/4 바퀴(FAN_FRAMES 프레임)만 있으면 됨, 프레임당 PI/20 (기존 0.15 rad 와 비슷한 속도)
+// 값 = floor(12 * cos/sin(a)), floor(9.6 * cos/sin(a + PI/6)), a = frame * PI/20 + blade * PI/2  (반지름 12 기준)
+#define FAN_RADIUS 12
+#define FAN_FRAMES 10
+
+const int8_t fanBladeLut[FAN_FRAMES][4][4] PROGMEM = {     // [프레임][날개] = { x1, y1, x2, y2 } 중심 기준 오프셋
+  { { 12,  0,  8,  4}, {  0, 12, -5,  8}, {-12,  0, -9, -5}, { -1,-12,  4, -9} },
+  { { 11,  1,  7,  6}, { -2, 11, -7,  7}, {-12, -2, -8, -7}, {  1,-12,  6, -8} },
+  { { 11,  3,  6,  7}, { -4, 11, -8,  6}, {-12, -4, -7, -8}, {  3,-12,  7, -7} },
+  { { 10,  5,  5,  8}, { -6, 10, -9,  5}, {-11, -6, -6, -9}, {  5,-11,  8, -6} },
+  { {  9,  7,  3,  8}, { -8,  9, -9,  3}, {-10, -8, -4, -9}, {  7,-10,  8, -4} },
+  { {  8,  8,  2,  9}, { -9,  8,-10,  2}, { -9, -9, -3,-10}, {  8, -9,  9, -3} },
+  { {  7,  9,  1,  9}, {-10,  7,-10,  1}, { -8,-10, -2,-10}, {  9, -8,  9, -2} },
+  { {  5, 10, -1,  9}, {-11,  5,-10, -1}, { -6,-11,  0,-10}, { 10, -6,  9,  0} },
+  { {  3, 11, -2,  9}, {-12,  3,-10, -2}, { -4,-12,  1,-10}, { 11, -4,  9,  1} },
+  { {  1, 11, -4,  8}, {-12,  1, -9, -4}, { -2,-12,  3, -9}, { 11, -2,  8,  3} },
+};
 
-void drawSpinningFan(int centerX, int centerY, int radius, uint16_t color) {
-    // 1. 이전 잔상을 지우기 (배경색이 검정색이라고 가정)
-    tft.fillCircle(centerX, centerY, radius + 2, TFT_BLACK);
+// LED 아이콘 광선 8개: floor(10 * cos/sin(i * PI/4)), floor(13 * cos/sin(i * PI/4))
+const int8_t ledRayLut[8][4] PROGMEM = {
+  { 10,  0, 13,  0}, {  7,  7,  9,  9}, {  0, 10,  0, 13}, { -8,  7,-10,  9},
+  {-10,  0,-13,  0}, { -8, -8,-10,-10}, { -1,-10, -1,-13}, {  7, -8,  9,-10},
+};
 
-    // 2. 4개의 날개 그리기 (90도 간격)
+// 애니메이션을 위한 변수 (루프 밖이나 클래스 멤버로 선언)
+uint8_t fan_frame = 0; 
+
+// 바람개비 한 프레임 (날개 4개 + 중앙 축)
+void drawFanFrame(int centerX, int centerY, uint8_t frame, uint16_t color) {
     for (int i = 0; i < 4; i++) {
-        float baseAngle = fan_angle + (i * PI / 2.0); // 90도(PI/2) 간격
+        const int8_t *b = fanBladeLut[frame][i];
+        // 중심점 / 바깥쪽 끝점 / 옆으로 퍼지는 점 (바람개비 날개 폭 결정) 으로 삼각형 날개 채우기
+        tft.fillTriangle(centerX, centerY, centerX + b[0], centerY + b[1], centerX + b[2], centerY + b[3], color);
+    }
+
+    // 중앙 축 (원본 이미지의 점 표현)
+    tft.fillCircle(centerX, centerY, 2, TFT_WHITE);
+}
 
-        // 날개의 세 꼭짓점 계산
-        // 중심점
-        int x0 = centerX;
-        int y0 = centerY;
+void drawSpinningFan(int centerX, int centerY, uint16_t color) {
+    tftSync();
+    // 1. 이전 잔상을 지우기 (배경색이 검정색이라고 가정)
+    tft.fillCircle(centerX, centerY, FAN_RADIUS + 2, TFT_BLACK);
+    uiCountPixels((uint32_t)(2 * FAN_RADIUS + 5) * (2 * FAN_RADIUS + 5));
 
-        // 바깥쪽 끝점
-        int x1 = centerX + radius * cos(baseAngle);
-        int y1 = centerY + radius * sin(baseAngle);
+    // 2. 4개의 날개 그리기 (90도 간격)
+    drawFanFrame(centerX, centerY, fan_frame, color);
 
-        // 옆으로 퍼지는 점 (바람개비 날개 폭 결정)
-        // baseAngle에서 약 30도(PI/6) 정도 옆으로 벌어진 지점
-        int x2 = centerX + (radius * 0.8) * cos(baseAngle + PI / 6.0);
-        int y2 = centerY + (radius * 0.8) * sin(baseAngle + PI / 6.0);
+    // 3. 회전 (1/4 바퀴마다 같은 모양 반복)
+    fan_frame = (fan_frame + 1) % FAN_FRAMES;
+}
+// ----------------------------------- 바람개비 아이콘(회전동작) -------------------------------------------
 
-        // 삼각형 날개 채우기
-        tft.fillTriangle(x0, y0, x1, y1, x2, y2, color);
-    }
 
-    // 3. 중앙 축 (원본 이미지의 점 표현)
-    tft.fillCircle(centerX, centerY, 2, TFT_WHITE);
 
-    // 4. 회전 속도 조절
-    fan_angle += 0.15; // 숫자가 클수록 빨리 회전합니다.
-    if (fan_angle >= 2 * PI) fan_angle = 0;
+// [추가] 수동 ON 자동 해제까지 남은 초 (-1 = 표시 안 함)
+long manualRemainSec(OperMode mode, unsigned long startTime, unsigned long limitMinutes) {
+    if (mode != ON || startTime == 0) return -1;
+    unsigned long elapsedSec = (millis() - startTime) / 1000;
+    long remain = (long)(limitMinutes * 60) - (long)elapsedSec;
+    return (remain < 0) ? 0 : remain;
 }
-// ----------------------------------- 바람개비 아이콘(회전동작) -------------------------------------------
 
+const char* modeLabel(OperMode mode) {
+    if (mode == AUTO) return "AUTO";
+    else if (mode == ON) return " ON ";
+    return " OFF";
+}
 
+// [추가] 아이콘 위젯 시작: 상태가 바뀐 경우에만 아이콘 칸을 지우고 true
+// 위젯 사각형 = 아이콘 칸(icon_y-15 ~ +17) + 위쪽 문구 2줄(icon_y-31 ~ -15)
+bool iconWidgetBegin(int id, int icon_x, int icon_y, int icon_gap, int min_x, uint32_t state) {
+    int x0 = icon_x - icon_gap / 2;
+    // 가로 모드: 얼굴이 있는 좌측(X=0~90)은 건드리지 않음 (min_x)
+    if (x0 < min_x) x0 = min_x;
+    int w = icon_x + icon_gap / 2 - x0;
 
-void drawStatusIcons() {   
-    int icon_x_start = 30;
-    if (screenRotation == 1) icon_x_start += 75;       // 가로모드에서 화면배치 수정(우측으로 이동)
+    if (!widgetBegin(id, x0, icon_y - 31, w, 48, state)) return false;
+    tft.fillRect(x0, icon_y - 15, w, 32, BG_COLOR);
+    return true;
+}
 
-    // 전역 변수 layout_icons_y 사용 (화면 방향에 따라 높이 자동 조절)
-    int icon_y = layout_icons_y + 6; 
-    int icon_gap = 60;
+// 모드 문구와 카운트다운 (배경색으로 덮어쓰기)
+void drawIconCaption(int icon_x, int icon_y, OperMode mode, long remain) {
+    tft.drawString(modeLabel(mode), icon_x - 12, icon_y - 21);
+    tft.drawString("      ", icon_x - 10, icon_y - 31); 
+    if (remain >= 0) tft.drawString((String)remain, icon_x - 6, icon_y - 31);
+}
 
-    // 영역 지우기 - 화면 전체 폭(tft.width())만큼 지워서 회전 시 잔상 방지
-    //tft.fillRect(0, icon_y - 15, tft.width(), 32, BG_COLOR);
-    
 
-    // [수정 후] 가로/세로 모드에 따라 지우는 영역 분리
-    if (screenRotation == 1) {
-        // 가로 모드: 얼굴이 있는 좌측(X=0~90)은 건드리지 않고, 아이콘 시작 지점 근처(90)부터 끝까지만 지움
-        tft.fillRect(90, icon_y - 15, tft.width() - 90, 32, BG_COLOR);
-    } else {
-        // 세로 모드: 기존처럼 전체 너비를 지움
-        tft.fillRect(0, icon_y - 15, tft.width(), 32, BG_COLOR);
-    }
 
+// [수정] 아이콘 4개를 각각 위젯으로 분리 -> 상태(점등/모드/카운트다운)가 바뀐 아이콘만 다시 그림
+template <int ROT>
+void drawStatusIconsFor() {
+    constexpr const ScreenLayout &L = SCREEN_LAYOUTS[ROT];
+    int icon_x_start = L.icon_x_start;                 // 가로모드는 우측으로 75px 이동된 값
 
+    // 화면 방향별 높이 (배치표)
+    const int icon_y = L.icons_y + 6; 
+    const int icon_gap = L.icon_gap;
 
     tft.setTextSize(1);
     tft.setTextColor(TFT_SILVER, BG_COLOR);
@@ -882,124 +1668,73 @@ void drawStatusIcons() {
     bool led_on = (brightnessStep[0] > 0 || brightnessStep[1] > 0);
     uint16_t led_color = led_on ? TFT_YELLOW : TFT_DARKGREY;
     
-    tft.fillCircle(icon_x_start, icon_y, 8, led_color);
-    for (int i=0; i<8; i++) { 
-        float angle = i * PI / 4;
-        int x1 = icon_x_start + 10 * cos(angle);
-        int y1 = icon_y + 10 * sin(angle);
-        int x2 = icon_x_start + 13 * cos(angle);
-        int y2 = icon_y + 13 * sin(angle);
-        tft.drawLine(x1, y1, x2, y2, led_color);
-    }
-    tft.drawString((String)brightnessStep[0], icon_x_start - 1, icon_y - 22);   // LED 밝기값 표시
+    if (iconWidgetBegin(W_ICON_LED, icon_x_start, icon_y, icon_gap, L.icon_min_x, widgetHash(widgetHash(WIDGET_HASH_INIT, led_on), brightnessStep[0]))) {
+        tft.fillCircle(icon_x_start, icon_y, 8, led_color);
+        for (int i=0; i<8; i++) { 
+            const int8_t *r = ledRayLut[i];
+            tft.drawLine(icon_x_start + r[0], icon_y + r[1], icon_x_start + r[2], icon_y + r[3], led_color);
+        }
+        tft.drawString("   ", icon_x_start - 1, icon_y - 22);
+        tft.drawString((String)brightnessStep[0], icon_x_start - 1, icon_y - 22);   // LED 밝기값 표시
+    }
     
     // ---------------------- 2. Humidifier Icon ----------------------
     icon_x_start += icon_gap;
-    bool humi_on = (digitalRead(HUMIDIFIER_PWR) == HIGH);
+    const CageState st = readState();                     // [수정] 릴레이 상태는 스냅샷에서
+    bool humi_on = (st.act & ACT_HUMIDIFIER) != 0;
     uint16_t humi_color = humi_on ? TFT_CYAN : TFT_DARKGREY;
+    long humiRemain = manualRemainSec(humidifierMode, manualHumidifierStartTime, HUMIDIFIER_AUTO_OFF_MINUTES);   // 가습기가 ON일때 카운트다운
   
-    tft.fillCircle(icon_x_start, icon_y - 3, 8, humi_color);
-    tft.fillTriangle(icon_x_start - 8, icon_y - 3, icon_x_start + 8, icon_y - 3, icon_x_start, icon_y + 9, humi_color);
-
-    String modeHumiStr;
-    if (humidifierMode == AUTO) modeHumiStr = "AUTO";
-    else if (humidifierMode == ON) modeHumiStr = " ON ";
-    else modeHumiStr = " OFF";
-
-    tft.drawString(modeHumiStr, icon_x_start - 12, icon_y - 21);
-    tft.drawString("      ", icon_x_start - 10, icon_y - 31); 
-
-    // 가습기가 ON일때 카운트다운
-    if (humidifierMode == ON && manualHumidifierStartTime > 0) {
-      unsigned long elapsedSec = (millis() - manualHumidifierStartTime) / 1000;
-      unsigned long limitSec = HUMIDIFIER_AUTO_OFF_MINUTES * 60;
-      long remain = (long)limitSec - (long)elapsedSec;
-      if (remain < 0) remain = 0; 
-      tft.drawString((String)remain, icon_x_start - 6, icon_y - 31);
+    if (iconWidgetBegin(W_ICON_HUMI, icon_x_start, icon_y, icon_gap, L.icon_min_x,
+                        widgetHash(widgetHash(widgetHash(WIDGET_HASH_INIT, humi_on), humidifierMode), humiRemain))) {
+        tft.fillCircle(icon_x_start, icon_y - 3, 8, humi_color);
+        tft.fillTriangle(icon_x_start - 8, icon_y - 3, icon_x_start + 8, icon_y - 3, icon_x_start, icon_y + 9, humi_color);
+        drawIconCaption(icon_x_start, icon_y, humidifierMode, humiRemain);
     }
 
     // ---------------------- 3. Heater Icon ----------------------
     icon_x_start += icon_gap;
-    bool heater_on = (digitalRead(HEATER_PIN) == HIGH); 
+    bool heater_on = (st.act & ACT_HEATER) != 0;
     uint16_t heater_color = heater_on ? TFT_RED : TFT_DARKGREY;
+    long heaterRemain = manualRemainSec(heaterMode, manualHeaterStartTime, HEATER_AUTO_OFF_MINUTES);            // 히터 ON일때 카운트다운
     
-    int heater_x = icon_x_start;
-    int heater_y = icon_y + 4;
-
-    tft.drawBitmap(heater_x - 15, heater_y - 15, hotSpring30, 30, 30, heater_color);
-
-    String modeHeatStr;
-    if (heaterMode == AUTO) modeHeatStr = "AUTO";
-    else if (heaterMode == ON) modeHeatStr = " ON ";
-    else modeHeatStr = " OFF";
-
-    tft.drawString(modeHeatStr, icon_x_start - 12, icon_y - 21);
-    tft.drawString("      ", icon_x_start - 10, icon_y - 31); 
+    if (iconWidgetBegin(W_ICON_HEATER, icon_x_start, icon_y, icon_gap, L.icon_min_x,
+                        widgetHash(widgetHash(widgetHash(WIDGET_HASH_INIT, heater_on), heaterMode), heaterRemain))) {
+        int heater_x = icon_x_start;
+        int heater_y = icon_y + 4;
 
-    // 히터 ON일때 카운트다운
-    if (heaterMode == ON && manualHeaterStartTime > 0) {
-      unsigned long elapsedSec = (millis() - manualHeaterStartTime) / 1000;
-      unsigned long limitSec = HEATER_AUTO_OFF_MINUTES * 60;
-      long remain = (long)limitSec - (long)elapsedSec;
-      if (remain < 0) remain = 0;
-      tft.drawString((String)remain, icon_x_start - 6, icon_y - 31);
+        tft.drawBitmap(heater_x - 15, heater_y - 15, hotSpring30, 30, 30, heater_color);
+        drawIconCaption(icon_x_start, icon_y, heaterMode, heaterRemain);
     }
 
 
     // ---------------------- 4. Fan Icon (수정됨) ----------------------
     icon_x_start += icon_gap;
-    bool fan_on = (digitalRead(FAN_PIN) == HIGH);
+    bool fan_on = (st.act & ACT_FAN) != 0;
+    long fanRemain = manualRemainSec(fanMode, manualFanStartTime, FAN_AUTO_OFF_MINUTES);
     
-    int fan_x = icon_x_start;
-    int fan_y = icon_y + 2;
-    int fan_radius = 12;
-
-    if (!fan_on) {
-         // [수정] OFF 상태일 때: 회전하지 않는(고정된) 회색 바람개비 그리기
-         
-         // 4개의 날개 그리기 (각도는 0으로 고정)
-         for (int i = 0; i < 4; i++) {
-             float baseAngle = (i * PI / 2.0); // 회전 변수 fan_angle 대신 0 사용
-
-             // 날개 좌표 계산 (drawSpinningFan과 동일한 로직)
-             int x1 = fan_x + fan_radius * cos(baseAngle);
-             int y1 = fan_y + fan_radius * sin(baseAngle);
-             int x2 = fan_x + (fan_radius * 0.8) * cos(baseAngle + PI / 6.0);
-             int y2 = fan_y + (fan_radius * 0.8) * sin(baseAngle + PI / 6.0);
-
-             // 회색(TFT_DARKGREY)으로 채우기
-             tft.fillTriangle(fan_x, fan_y, x1, y1, x2, y2, TFT_DARKGREY);
-         }
-         // 중앙 점 (흰색)
-         tft.fillCircle(fan_x, fan_y, 2, TFT_WHITE);
-
-    } else {
-         // ON 상태일 때: 회전하는 초록색 바람개비 (애니메이션 함수 호출)
-         drawSpinningFan(fan_x, fan_y, fan_radius, TFT_GREEN);
-    }
-
-    String modeFanStr = {};
-    if (fanMode == AUTO) modeFanStr = "AUTO";
-    else if (fanMode == ON) modeFanStr = " ON ";
-    else modeFanStr = " OFF";
-
-    tft.drawString(modeFanStr, icon_x_start - 12, icon_y - 21);
-    tft.drawString("      ", icon_x_start - 10, icon_y - 31); 
+    // 회전 애니메이션은 loop()에서 100ms 마다 따로 그림 -> 여기서는 상태가 바뀔 때만
+    if (iconWidgetBegin(W_ICON_FAN, icon_x_start, icon_y, icon_gap, L.icon_min_x,
+                        widgetHash(widgetHash(widgetHash(WIDGET_HASH_INIT, fan_on), fanMode), fanRemain))) {
+        int fan_x = icon_x_start;
+        int fan_y = icon_y + 2;
+
+        if (!fan_on) {
+             // [수정] OFF 상태일 때: 회전하지 않는(고정된, 프레임 0) 회색 바람개비 그리기
+             drawFanFrame(fan_x, fan_y, 0, TFT_DARKGREY);
+        } else {
+             // ON 상태일 때: 회전하는 초록색 바람개비 (애니메이션 함수 호출)
+             drawSpinningFan(fan_x, fan_y, TFT_GREEN);
+        }
 
-    if (fanMode == ON && manualFanStartTime > 0) {
-      unsigned long elapsedSec = (millis() - manualFanStartTime) / 1000;
-      unsigned long limitSec = FAN_AUTO_OFF_MINUTES * 60;
-      long remain = (long)limitSec - (long)elapsedSec;
-      if (remain < 0) remain = 0; 
-      tft.drawString((String)remain, icon_x_start - 6, icon_y - 31);
+        drawIconCaption(icon_x_start, icon_y, fanMode, fanRemain);
     }
-
-
 }
 
 
 
 void drawLEDUI(int led, int y, int level, bool selected) {
+  tftSync();
   int barX = 90; int barW = 120; int barH = 16;
   tft.fillRect(0, y, 240, 28, BG_COLOR);
   tft.setTextSize(2); tft.setTextColor(TFT_WHITE, BG_COLOR);
@@ -1012,104 +1747,155 @@ void drawLEDUI(int led, int y, int level, bool selected) {
 }
 
 
-void drawGraphFrame() { tft.drawRect(layout_graph_x - 1, layout_graph_y - 1, layout_graph_w + 2, layout_graph_h + 2, TFT_WHITE); }
+void drawGraphFrame() { tftSync(); tft.drawRect(layout->graph_x - 1, layout->graph_y - 1, layout->graph_w + 2, layout->graph_h + 2, TFT_WHITE); }
 
-int getSecondsPerPixel() {
-    switch (displayHours) {
-        case 1:  return 15; case 6:  return 90;
-        case 12: return 180; case 24: return 360;
-    }
-    return 15;
-}
 
 
 
 // 스프라이트에 격자 그리기 (좌표 보정 적용)
-void drawGraphGrid(const TimeAxisState &axis) {
-  const int Y_GRID_STEP = 20;
-  for (int v = Y_MIN + Y_GRID_STEP; v <= Y_MAX; v += Y_GRID_STEP) {
-    int y = map(v, Y_MIN, Y_MAX, layout_graph_h, 0);                                          // [보정] layout_graph_y+layout_graph_h -> layout_graph_h, layout_graph_y -> 0
-    // tft.drawLine(...) 대신 graphSprite.drawLine(...) 사용
-    // X좌표도 절대좌표가 아닌 스프라이트 내부 좌표(0 ~ layout_graph_w-1) 사용
-    graphSprite.drawLine(0, y, layout_graph_w - 1, y, GRID_COLOR);
+// [수정] fromCol ~ toCol 컬럼 범위만 그림 (전체 다시 그리기 / 스크롤로 새로 생긴 컬럼)
+void drawGraphGrid(const TimeAxisState &axis, uint32_t fromCol, uint32_t toCol) {
+  int x0 = max(graphColumnX(axis, fromCol), 0);
+  int x1 = min(graphColumnX(axis, toCol), layout->graph_w - 1);
+  if (x1 < x0) return;
+
+  const GraphYAxis &ya = graphYAxis[GS_TEMP];                      // 두 축의 격자 칸 수가 같으므로 가로선은 온도 축 기준
+  for (int v = ya.lo10 + ya.step10; v <= ya.hi10; v += ya.step10) {                            // [수정] 자동 조정된 Y축
+    int y = map(v, ya.lo10, ya.hi10, layout->graph_h, 0);                                      // [보정] layout->graph_y+layout->graph_h -> layout->graph_h, layout->graph_y -> 0
+    graphSprite.drawFastHLine(x0, y, x1 - x0 + 1, graphColor(GC_GRID));
   }
-  for (int i = 0; i < layout_num_labels; i++) {
-    float offsetMin = (layout_num_labels - 1 - i) * axis.labelStepMin;
-    // [보정] anchorX는 절대좌표이므로 layout_graph_x를 빼서 스프라이트 상대좌표로 변환
-    int x = (axis.anchorX - layout_graph_x) - (int)((offsetMin / axis.minPerPx) + 0.5f);
-    if (x < 0 || x >= layout_graph_w) continue;                                               // [보정] 범위 체크도 0 ~ layout_graph_w 기준
-    graphSprite.drawFastVLine(x, 0, layout_graph_h, GRID_COLOR);                              // [보정] y시작점 0
+
+  // 해당 컬럼 구간 [t0, t1) 안의 격자 시각마다 세로선
+  uint32_t t0 = graphColumnStartTs(fromCol);
+  uint32_t t1 = graphColumnStartTs(toCol + 1);
+  uint32_t step = axis.gridStepSec;
+  uint32_t g = ((t0 + LOCAL_TZ_OFFSET_SEC + step - 1) / step) * step - LOCAL_TZ_OFFSET_SEC;
+  for (; g < t1; g += step) {
+    int x = graphColumnX(axis, graphColumnOf(g));
+    if (x < 0 || x >= layout->graph_w) continue;                                               // [보정] 범위 체크도 0 ~ layout->graph_w 기준
+    graphSprite.drawFastVLine(x, 0, layout->graph_h, graphColor(GC_GRID));                     // [보정] y시작점 0
   }
 }
 
 
 
+// 시간 스케일 표시 (1H, 6H 등) - 그래프 영역 안쪽이라 스크롤되지 않도록 별도 스프라이트에 그려 두고
+// 전송할 때 덮어씀 (graphFlushBegin / prepareGraphStrip)
+// [수정] 히스토리 화면에서는 다른 색 (color)
+void drawGraphModeTag(uint16_t color = TFT_DARKCYAN) {
+  if (!graphTagSprite.created()) {
+    graphTagSprite.setColorDepth(16);
+    graphTagSprite.createSprite(18, 8);                         // 글자 3개 (6x8)
+  }
+  graphTagSprite.fillSprite(BG_COLOR);
+  graphTagSprite.setTextSize(1);
+  graphTagSprite.setTextColor(color, BG_COLOR);
+  graphTagSprite.setCursor(0, 0);
+  graphTagSprite.printf("%dH", displayHoursOptions[displayHoursIndex]);
+}
 
-void drawGraphLabels(const TimeAxisState &axis) {
-  // 1. 시간 스케일 표시 (1H, 6H 등)
-  tft.setTextSize(1);
-  tft.setTextColor(TFT_DARKCYAN, BG_COLOR);
-  tft.setCursor(layout_graph_x + 8, layout_graph_y + 8);
-  tft.printf("%dH", displayHoursOptions[displayHoursIndex]);
 
-  // 2. Y축 라벨 (온도/습도 숫자) 그리기
-  tft.setTextSize(1);
-  tft.setTextColor(TFT_DARKCYAN, BG_COLOR);
 
-  for (int v = Y_MIN + 20; v <= Y_MAX; v += 20) {
-    int y = map(v, Y_MIN, Y_MAX, layout_graph_y + layout_graph_h, layout_graph_y);
-    
-    if (screenRotation == 1) {
-      tft.setCursor(layout_graph_x - 18, y - 4);                         // LANDSCAPE (가로) 좌표 보정
-    } else { 
-      tft.setCursor(layout_graph_x - 16, y - 2);                         // PORTRAIT (세로) 좌표 보정
+// [수정] full = false 이면 X축(시간) 라벨만 다시 그림 (스크롤 시)
+template <int ROT>
+void drawGraphLabelsFor(const TimeAxisState &axis, bool full) {
+  constexpr const ScreenLayout &L = SCREEN_LAYOUTS[ROT];
+  tftSync();
+
+  if (full) {
+    // 2. Y축 라벨 (왼쪽: 온도, 오른쪽: 습도 숫자) 그리기
+    tft.setTextSize(1);
+
+    // [추가] Y축 범위가 바뀌면 라벨 위치도 바뀌므로 라벨 영역을 먼저 지움
+    tft.fillRect(L.graph_x - 18, L.graph_y - 4, 17, L.graph_h + 9, BG_COLOR);
+    tft.fillRect(L.graph_x + L.graph_w + 1, L.graph_y - 4, 20, L.graph_h + 9, BG_COLOR);
+    uiCountPixels((uint32_t)(17 + 20) * (L.graph_h + 9));
+
+    // [수정] 두 축은 격자 칸 수가 같으므로 k 번째 라벨은 같은 높이
+    const GraphYAxis &ta = graphYAxis[GS_TEMP], &ha = graphYAxis[GS_HUMI];
+    int divs = (ta.hi10 - ta.lo10) / ta.step10;
+    for (int k = 1; k <= divs; k++) {
+      int y = map(k, 0, divs, L.graph_y + L.graph_h, L.graph_y);
+
+      tft.setTextColor(graphPalette[GC_TEMP], BG_COLOR);
+      tft.setCursor(L.graph_x + L.ylabel_dx, y + L.ylabel_dy);             // 방향별 좌표 보정
+      tft.printf("%d", (ta.lo10 + k * ta.step10) / 10);
+      tft.setTextColor(graphPalette[GC_HUMI], BG_COLOR);
+      tft.setCursor(L.graph_x + L.graph_w + L.hlabel_dx, y + L.ylabel_dy);
+      tft.printf("%d", (ha.lo10 + k * ha.step10) / 10);
     }
-    tft.printf("%d", v);
-  }
 
-  // Y축 최솟값(0) 그리기
-  int y0 = layout_graph_y + layout_graph_h;
-  if (screenRotation == 1) {                                              // LANDSCAPE
-     tft.setCursor(layout_graph_x - 12, y0 - 6);
-  } else {                                                                // PORTRAIT
-     tft.setCursor(layout_graph_x - 8, y0 - 4);
+    // Y축 최솟값(0) 그리기
+    int y0 = L.graph_y + L.graph_h;
+    tft.setTextColor(graphPalette[GC_TEMP], BG_COLOR);
+    tft.setCursor(L.graph_x + L.y0label_dx, y0 + L.y0label_dy);
+    tft.printf("%d", ta.lo10 / 10);
+    tft.setTextColor(graphPalette[GC_HUMI], BG_COLOR);
+    tft.setCursor(L.graph_x + L.graph_w + L.hlabel_dx, y0 + L.y0label_dy);
+    tft.printf("%d", ha.lo10 / 10);
+
+    // 4. 그래프 외곽선 그리기
+    tft.drawRect(L.graph_x - 1, L.graph_y - 1, L.graph_w + 2, L.graph_h + 2, TFT_WHITE);
   }
-  tft.printf("%d", Y_MIN);
 
   // 3. X축 라벨 (시간) 그리기
   // 그래프 아래쪽 영역 지우기 (잔상 제거)
 
   tft.setTextSize(1);                                                       // FreeFont는 기본 크기 사용
 
-  tft.fillRect(0, layout_graph_y + layout_graph_h + 4, layout_graph_w + 44, 14, BG_COLOR);
+  tft.fillRect(0, L.graph_y + L.graph_h + 4, L.graph_w + 44, 14, BG_COLOR);
+  uiCountPixels((uint32_t)(L.graph_w + 44) * 14);
 
-  for (int i = 0; i < layout_num_labels; i++) {
-    float offsetMin = (layout_num_labels - 1 - i) * axis.labelStepMin;
-    int labelMin = axis.anchorMin - (int)(offsetMin + 0.5f);
-    labelMin = (labelMin + 1440) % 1440;
-    
-    int x = axis.anchorX - (int)((offsetMin / axis.minPerPx) + 0.5f);
+  uint32_t t0 = graphColumnStartTs(graphLeftCol(axis));
+  uint32_t t1 = graphColumnStartTs(axis.rightCol + 1);
+  uint32_t step = axis.gridStepSec;
+  uint32_t g = ((t0 + LOCAL_TZ_OFFSET_SEC + step - 1) / step) * step - LOCAL_TZ_OFFSET_SEC;
+
+  for (; g < t1; g += step) {
+    int x = L.graph_x + graphColumnX(axis, graphColumnOf(g));
     
     // 그래프 범위를 벗어나면 그리지 않음
-    if (x < layout_graph_x || x > layout_graph_x + layout_graph_w) continue;
+    if (x < L.graph_x || x > L.graph_x + L.graph_w) continue;
+
+    int labelMin = (int)(((g + LOCAL_TZ_OFFSET_SEC) % 86400UL) / 60);
     
     char buf[6];
     snprintf(buf, sizeof(buf), "%02d:%02d", labelMin / 60, labelMin % 60);
     tft.setTextColor(TFT_DARKGREEN, BG_COLOR);
 
-    // #if defined 대신 변수로 분기
-    if (screenRotation == 1) {                                                      // LANDSCAPE
-        tft.setCursor(x - 14 + 4, layout_graph_y + layout_graph_h + 6);
-    } else {                                                                        // PORTRAIT
-        tft.setCursor(x - 20 + 4, layout_graph_y + layout_graph_h + 5);
-    }
+    // 방향별 보정값은 배치표에서 (컴파일 타임 상수)
+    tft.setCursor(x + L.xlabel_dx, L.graph_y + L.graph_h + L.xlabel_dy);
     
     tft.print(buf); 
-    // tft.print("     "); // (선택) 공백 출력은 상황에 따라 제거 가능
   }
+}
+
+
+
+// [추가] 방향별 렌더러: 템플릿 인스턴스를 방향마다 묶어 둔 표 -> 회전 변경은 uiRenderer 포인터 교체
+struct UiRenderer {
+  const ScreenLayout* layout;
+  void (*timeTempHumi)(float, float);
+  void (*conditionFace)();
+  void (*statusIcons)();
+  void (*graphLabels)(const TimeAxisState &, bool);
+};
 
-  // 4. 그래프 외곽선 그리기
-  tft.drawRect(layout_graph_x - 1, layout_graph_y - 1, layout_graph_w + 2, layout_graph_h + 2, TFT_WHITE);
+const UiRenderer UI_RENDERERS[2] = {
+  { &SCREEN_LAYOUTS[0], drawTimeTempHumiFor<0>, drawConditionFaceFor<0>, drawStatusIconsFor<0>, drawGraphLabelsFor<0> },
+  { &SCREEN_LAYOUTS[1], drawTimeTempHumiFor<1>, drawConditionFaceFor<1>, drawStatusIconsFor<1>, drawGraphLabelsFor<1> },
+};
+const UiRenderer* uiRenderer = &UI_RENDERERS[0];
+
+void drawTimeTempHumi(float t, float h) { uiRenderer->timeTempHumi(t, h); }
+void drawConditionFace() { uiRenderer->conditionFace(); }
+void drawStatusIcons() { uiRenderer->statusIcons(); }
+void drawGraphLabels(const TimeAxisState &axis, bool full) { uiRenderer->graphLabels(axis, full); }
+
+// [수정] 회전 모드에 따른 배치: 배치표와 렌더러 포인터만 바꿈
+void updateLayout() {
+  uiRenderer = &UI_RENDERERS[screenRotation == 1 ? 1 : 0];
+  layout = uiRenderer->layout;
 }
 
 
@@ -1120,122 +1906,517 @@ void drawGraphLabels(const TimeAxisState &axis) {
 
 
 
-// 스프라이트에 데이터 선 그리기 (좌표 보정 적용)
-void drawGraphData() {
-    if (!timeSynced) return;
-    time_t nowTs = time(nullptr);
-    // int graphBottom = layout_graph_y + layout_graph_h; // [삭제] 안 씀
-    float scale = (float)layout_graph_h / (Y_MAX - Y_MIN);
-    int prevTempX = -1, prevTempY = -1;
-    int prevHumiX = -1, prevHumiY = -1;
-    uint32_t prevValidTs = 0;
-
-    int record_count = isDisplayBufferFull ? DISPLAY_MAX_SAMPLES : displayLogIndex;
-
-    for (int i = 0; i < record_count; i++) {
-        int idx = (displayLogIndex - record_count + i + DISPLAY_MAX_SAMPLES) % DISPLAY_MAX_SAMPLES;
-        LogRecord rec = displayLogBuf[idx];
-        bool isDataGap = false;
-        if (rec.ts == 0 || rec.ts == 0xFFFFFFFF) isDataGap = true;
-        else if (prevValidTs != 0 && (rec.ts - prevValidTs) > (GRAPH_SAMPLE_INTERVAL_SEC * 1.5)) isDataGap = true;
-        
-        if (isDataGap) {
-            prevTempX = -1; prevHumiX = -1; prevValidTs = 0; continue;
-        }
+// [추가] 스크롤 그래프 상태 (증분 렌더링)
+struct GraphScrollState {
+  bool valid = false;                 // false 이면 다음 drawGraph() 에서 전체 다시 그리기
+  bool composing = false;             // [추가] 전체 다시 그리기가 composeCol 에서 멈춤 (다음 drawGraph() 에서 이어서)
+  uint32_t rightCol = 0;              // 스프라이트에 그려진 오른쪽 끝 컬럼
+  uint32_t dataCol = 0;               // 마지막으로 그린 데이터 컬럼 (이후 샘플이 더 들어올 수 있음)
+  uint32_t composeCol = 0;            // 이어서 그릴 첫 컬럼
+  uint32_t composeUs = 0;             // 지금까지의 조각들이 loop() 를 막은 시간
+  unsigned long composeStartUs = 0;   // 첫 조각 시작 시각 (프레임 시간 통계)
+};
+GraphScrollState graphScroll = { false };
+
+// [추가] 히스토리 화면 상태 (엔코더로 /log.bin 을 앞뒤로 이동, 클릭으로 확대/축소)
+struct HistView {
+  bool active = false;
+  bool dirty = false;                 // 다음 UJ_GRAPH 에서 다시 그림
+  uint32_t rightCol = 0;              // 오른쪽 끝 절대 컬럼 (현재 모드 기준)
+  uint32_t oldestTs = 0;              // 로그에서 가장 오래된 레코드 시각
+  unsigned long lastInputMs = 0;
+  uint32_t useClock = 0;              // 페이지 LRU 용
+  uint32_t hits = 0, misses = 0, prefetches = 0;  // 그릴 때 페이지가 준비돼 있었는지 / 미리 읽은 페이지 수
+  uint32_t stallUs = 0, stallMaxUs = 0;           // 그릴 때 플래시를 직접 읽느라 걸린 시간
+};
+HistView histView = { false };
 
-        unsigned long secondsAgo = nowTs - rec.ts;
-        if (secondsAgo > displayHours * 3600UL) {
-             prevTempX = -1; prevHumiX = -1; prevValidTs = 0; continue;
-        }
+// 모드 변경, 화면 회전, 화면 전체 지우기, 로그 삭제 후 호출 -> 다음 drawGraph() 는 전체 다시 그리기
+void invalidateGraph() {
+  graphScroll.valid = false;
+  graphScroll.composing = false;
+  histView.dirty = true;
+}
 
-        // [보정] 절대 X좌표 계산 후 layout_graph_x를 빼서 스프라이트 좌표로 변환
-        int currAbsX = layout_graph_x + layout_graph_w - (int)((float)secondsAgo / secondsPerPixel);
-        int currX = currAbsX - layout_graph_x;
 
-        if (currX < 0 || currX >= layout_graph_w) { // [보정] 범위 체크 0 ~ layout_graph_w
-             prevTempX = -1; prevHumiX = -1; prevValidTs = 0; continue;
-        }
 
-        if (rec.temp != INVALID_VALUE) {
-            // [보정] Y좌표 계산: layout_graph_h(바닥) 기준으로 계산
-            int currTempY = layout_graph_h - (int)(((rec.temp / 10.0f) - Y_MIN) * scale + 0.5f);
-            currTempY = constrain(currTempY, 0, layout_graph_h - 1); // [보정] 0 ~ layout_graph_h-1
-            if (prevTempX != -1) {
-                // [보정] graphSprite에 그리기
-                graphSprite.drawLine(prevTempX, prevTempY, currX, currTempY, TFT_YELLOW);
-            }
-            prevTempX = currX; prevTempY = currTempY;
-        } else { prevTempX = -1; }
-
-        if (rec.humi != INVALID_VALUE) {
-            // [보정] Y좌표 계산
-            int currHumiY = layout_graph_h - (int)(((rec.humi / 10.0f) - Y_MIN) * scale + 0.5f);
-            currHumiY = constrain(currHumiY, 0, layout_graph_h - 1); // [보정]
-            if (prevHumiX != -1) {
-                // [보정] graphSprite에 그리기
-                graphSprite.drawLine(prevHumiX, prevHumiY, currX, currHumiY, TFT_GREEN);
-            }
-            prevHumiX = currX; prevHumiY = currHumiY;
-        } else { prevHumiX = -1; }
+// [수정] 값(0.1 단위 정수) -> Y좌표: float 나눗셈/곱셈 대신 Q16 고정소수점 배율 (createGraphSprite, Y축 변경 시 계산)
+int32_t graphYScaleQ16[NUM_GRAPH_SERIES] = { 0 };                 // layout->graph_h / (hi10 - lo10), 계열별
 
-        if (rec.ts != 0 && rec.ts != 0xFFFFFFFF && rec.temp != INVALID_VALUE && rec.humi != INVALID_VALUE) {
-             prevValidTs = rec.ts;
-        }
+void updateGraphYScale() {
+  for (int s = 0; s < NUM_GRAPH_SERIES; s++) {
+    graphYScaleQ16[s] = ((int32_t)layout->graph_h << 16) / (graphYAxis[s].hi10 - graphYAxis[s].lo10);
   }
 }
 
+int floorDiv(int a, int b) { return (a >= 0) ? a / b : -((-a + b - 1) / b); }
+
+// 보이는 구간의 min/max 로 Y축 범위 결정: 1/2/5/10/20 간격 중 격자 5칸 이하가 되는 가장 작은 간격에 맞춤
+// 간격 단위로 반올림하므로 값이 조금 움직여도 범위는 그대로 (범위가 바뀌면 true -> 전체 다시 그림)
+// [수정] 온도/습도 계열마다 따로 맞춘 뒤, 가로 격자선을 같이 쓰도록 칸 수가 적은 축을 위아래로 넓혀 칸 수를 맞춤
+// dataLo[s] == INVALID_VALUE 이면 그 계열은 Y_MIN ~ Y_MAX (히스토리 화면도 같은 규칙)
+bool graphYAxisFit(const int16_t dataLo[NUM_GRAPH_SERIES], const int16_t dataHi[NUM_GRAPH_SERIES]) {
+#if GRAPH_Y_AUTOSCALE
+  static const int16_t STEPS10[] = { 10, 20, 50, 100, 200 };
+  int loS[NUM_GRAPH_SERIES], hiS[NUM_GRAPH_SERIES], step10[NUM_GRAPH_SERIES];
+  int divs = 2;
+  for (int s = 0; s < NUM_GRAPH_SERIES; s++) {
+    step10[s] = 200;
+    loS[s] = floorDiv(Y_MIN * 10, 200);
+    hiS[s] = -floorDiv(-Y_MAX * 10, 200);
+    if (dataLo[s] != INVALID_VALUE) {
+      for (size_t i = 0; i < sizeof(STEPS10) / sizeof(STEPS10[0]); i++) {
+        step10[s] = STEPS10[i];
+        loS[s] = floorDiv(dataLo[s], step10[s]);
+        hiS[s] = -floorDiv(-dataHi[s], step10[s]);                // 올림
+        if (hiS[s] - loS[s] <= 5) break;
+      }
+    }
+    divs = max(divs, hiS[s] - loS[s]);                            // 평평한 구간도 격자 2칸 이상
+  }
+
+  bool changed = false;
+  for (int s = 0; s < NUM_GRAPH_SERIES; s++) {
+    int extra = divs - (hiS[s] - loS[s]);
+    int lo10 = (loS[s] - extra / 2) * step10[s];
+    int hi10 = (hiS[s] + extra - extra / 2) * step10[s];
+    GraphYAxis &ya = graphYAxis[s];
+    if (lo10 == ya.lo10 && hi10 == ya.hi10) continue;
+    ya.lo10 = lo10;
+    ya.hi10 = hi10;
+    ya.step10 = step10[s];
+    changed = true;
+  }
+  if (!changed) return false;
+  graphYRescales++;
+  updateGraphYScale();
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool updateGraphYAxis(const TimeAxisState &axis) {
+  uint32_t leftCol = graphLeftCol(axis);
+  int16_t lo[NUM_GRAPH_SERIES], hi[NUM_GRAPH_SERIES];
+  for (int s = 0; s < NUM_GRAPH_SERIES; s++) {
+    GraphRangeDeque &mn = graphRangeMin[s], &mx = graphRangeMax[s];
+    graphRangeEvict(mn, leftCol);
+    graphRangeEvict(mx, leftCol);
+    bool hasData = mn.count && mx.count;
+    lo[s] = hasData ? mn.e[mn.head].v : (int16_t)INVALID_VALUE;
+    hi[s] = hasData ? mx.e[mx.head].v : (int16_t)INVALID_VALUE;
+  }
+  return graphYAxisFit(lo, hi);
+}
+
+int graphValueY(GraphSeries s, int16_t v10) {
+  // [보정] Y좌표 계산: layout->graph_h(바닥) 기준으로 계산
+  int y = layout->graph_h - (int)((((int32_t)v10 - graphYAxis[s].lo10) * graphYScaleQ16[s] + 0x8000) >> 16);
+  return constrain(y, 0, layout->graph_h - 1);                     // [보정] 0 ~ layout->graph_h-1
+}
+
+// 컬럼 하나의 세로 막대: min ~ max, 앞 컬럼 마지막 값(from)까지 이어서 선처럼 보이게 함
+void drawEnvelopeSpan(GraphSeries s, int x, int16_t mn, int16_t mx, int16_t from, uint16_t color) {
+  if (mn == INVALID_VALUE) return;
+  if (from != INVALID_VALUE) {
+    if (from < mn) mn = from;
+    if (from > mx) mx = from;
+  }
+  int yTop = graphValueY(s, mx);
+  int yBot = graphValueY(s, mn);
+  graphSprite.drawFastVLine(x, yTop, yBot - yTop + 1, color);
+}
+
+
+
+// [추가] 액추에이터 띠: 그래프 바닥에 히터/가습기/팬 순으로 2픽셀씩, 곡선보다 먼저 그려서 곡선이 위에 보이게 함
+#define ACT_BAND_H 2
+const GraphColor ACT_BAND_COLORS[NUM_ACT_BANDS] = { GC_HEATER, GC_HUMIDIFIER, GC_FAN };
+
+void drawActuatorBands(int x, uint8_t act) {
+  for (int b = 0; b < NUM_ACT_BANDS; b++) {
+    if (act & (1 << b)) graphSprite.drawFastVLine(x, layout->graph_h - (b + 1) * ACT_BAND_H, ACT_BAND_H, graphColor(ACT_BAND_COLORS[b]));
+  }
+}
+
+// 스프라이트에 데이터 그리기 (좌표 보정 적용)
+// [수정] 현재 모드의 엔벨로프에서 fromCol ~ toCol 컬럼만 그림 (샘플 수와 무관하게 O(그래프 폭))
+void drawGraphData(const TimeAxisState &axis, uint32_t fromCol, uint32_t toCol) {
+    if (!timeSynced) return;
+
+    const GraphEnvelope &env = graphEnv[displayHoursIndex];
+    for (uint32_t c = fromCol; c <= toCol; c++) {
+        int x = graphColumnX(axis, c);
+        if (x < 0 || x >= layout->graph_w) continue;               // [보정] 범위 체크 0 ~ layout->graph_w
+
+        const GraphEnvCol &e = env.cols[c % GRAPH_ENV_COLS];
+        if (e.col != c) continue;
+        drawActuatorBands(x, e.act);
+        drawEnvelopeSpan(GS_TEMP, x, e.tMin, e.tMax, e.tFrom, graphColor(GC_TEMP));
+        drawEnvelopeSpan(GS_HUMI, x, e.hMin, e.hMax, e.hFrom, graphColor(GC_HUMI));
+    }
+}
+
+
+
+
+// [추가] 스프라이트를 shift 컬럼만큼 왼쪽으로 밀고 오른쪽 빈 컬럼은 배경색으로
+// TFT_eSprite::scroll() 은 4비트 스프라이트를 지원하지 않으므로 니블 단위로 직접 이동 (GC_BG = 0)
+void scrollGraphLeft(int shift) {
+#if GRAPH_SPRITE_BPP == 4
+  uint8_t* img = (uint8_t*)graphSprite.getPointer();
+  int rowBytes = layout->graph_w / 2;
+  int m = shift / 2;
+  for (int y = 0; y < layout->graph_h; y++) {
+    uint8_t* row = img + y * rowBytes;
+    int keep;
+    if ((shift & 1) == 0) {
+      keep = rowBytes - m;
+      memmove(row, row + m, keep);
+    } else {
+      keep = rowBytes - m - 1;                                    // 픽셀 2i <- 2i+shift (하위 니블), 2i+1 <- 다음 바이트 상위 니블
+      for (int i = 0; i < keep; i++) row[i] = (uint8_t)((row[i + m] << 4) | (row[i + m + 1] >> 4));
+      if (keep >= 0 && keep < rowBytes) row[keep] = (uint8_t)(row[rowBytes - 1] << 4);
+      keep++;
+    }
+    if (keep < rowBytes) memset(row + keep, 0, rowBytes - keep);
+  }
+#else
+  graphSprite.scroll(-shift, 0);                                  // 비워진 컬럼은 setScrollRect 의 배경색으로 채워짐
+#endif
+}
 
 
 
 // 메인 그래프 그리기 함수
-void drawGraph() {
+// [수정] 스크롤 + 추가분만 그리기: 경과한 컬럼 수만큼 스프라이트를 왼쪽으로 밀고
+//        마지막 데이터 컬럼부터 오른쪽 끝까지만 다시 그림
+//        전체 다시 그리기는 invalidateGraph() 이후 (모드 변경, 회전, 화면 지우기) 또는 시간이 튄 경우에만
+// [수정] budgetUs > 0 이면 전체 다시 그리기를 GRAPH_COMPOSE_SLICE_COLS 컬럼씩 그리다 예산이 끝나면 멈추고
+//        다음 호출에서 이어서 그림 (그 사이 오른쪽 끝 컬럼이나 Y축이 바뀌면 처음부터). 0 이면 한 번에
+//        반환값: 스프라이트가 최신이면 true, 이어서 그릴 것이 남았으면 false (호출한 쪽이 다시 요청)
+#define GRAPH_COMPOSE_SLICE_COLS 16     // 예산 확인 간격 (컬럼)
+
+bool drawGraph(uint32_t budgetUs) {
+  unsigned long startUs = micros();
   TimeAxisState axis;
   computeTimeAxis(axis);
 
-  // 1. 스프라이트를 배경색으로 채움 (메모리상에서 지우기)
-  graphSprite.fillSprite(BG_COLOR); 
-  
-  // 2. 스프라이트에 격자와 데이터 그림
-  drawGraphGrid(axis);
-  drawGraphData();
+  bool rescaled = updateGraphYAxis(axis);                           // [추가] Y축 범위가 바뀌면 전체 다시 그림
+  bool resume = graphScroll.composing && !rescaled && axis.rightCol == graphScroll.rightCol;
+  bool full = resume || rescaled || !graphScroll.valid
+           || axis.rightCol < graphScroll.rightCol
+           || axis.rightCol - graphScroll.rightCol >= (uint32_t)layout->graph_w;
+  uint32_t shift = full ? 0 : axis.rightCol - graphScroll.rightCol;
+  uint32_t fromCol = graphLeftCol(axis);
+
+  if (resume) {
+    fromCol = graphScroll.composeCol;
+  } else if (full) {
+    // 1. 스프라이트를 배경색으로 채움 (메모리상에서 지우기)
+    graphSprite.fillSprite(graphColor(GC_BG)); 
+    drawGraphGrid(axis, fromCol, axis.rightCol);
+    graphScroll.composing = true;
+    graphScroll.composeUs = 0;
+    graphScroll.composeStartUs = startUs;
+    graphScroll.dataCol = graphEnv[displayHoursIndex].lastCol;      // 그리는 동안 샘플이 더 들어오면 다음 호출에서 여기부터 다시
+  } else {
+    if (shift > 0) scrollGraphLeft((int)shift);                     // 비워진 컬럼은 배경색으로 채워짐
+
+    // 마지막 데이터 컬럼은 그 사이 샘플이 더 들어왔을 수 있으므로 지우고 다시 그림
+    if (graphScroll.dataCol > fromCol) fromCol = graphScroll.dataCol;
+    int x0 = graphColumnX(axis, fromCol);
+    if (x0 < layout->graph_w) {
+      graphSprite.fillRect(x0, 0, layout->graph_w - x0, layout->graph_h, graphColor(GC_BG));
+      drawGraphGrid(axis, fromCol, axis.rightCol);
+    }
+    graphScroll.dataCol = graphEnv[displayHoursIndex].lastCol;
+  }
+  graphScroll.rightCol = axis.rightCol;
+
+  // 2. 데이터 그리기 (전체 or 마지막 데이터 컬럼 이후만)
+  if (full && budgetUs > 0) {
+    while (fromCol <= axis.rightCol) {
+      uint32_t toCol = min(fromCol + GRAPH_COMPOSE_SLICE_COLS - 1, axis.rightCol);
+      drawGraphData(axis, fromCol, toCol);
+      fromCol = toCol + 1;
+      if (fromCol <= axis.rightCol && micros() - startUs >= budgetUs) {
+        graphScroll.composeCol = fromCol;                           // 예산 끝: 다음 loop 에서 이어서
+        graphScroll.composeUs += micros() - startUs;
+        return false;
+      }
+    }
+  } else {
+    drawGraphData(axis, fromCol, axis.rightCol);
+  }
+  graphScroll.composing = false;
+  graphScroll.valid = true;
   
-  // 3. 완성된 스프라이트를 실제 화면의 지정된 위치에 전송 (깜빡임 없이 표시됨)
-  graphSprite.pushSprite(layout_graph_x, layout_graph_y);
+  // 3. 라벨과 외곽선은 스프라이트 바깥이므로 기존 tft 객체로 그림 (스크롤이 있을 때만)
+  //    DMA 전송을 시작한 뒤에 그리면 전송이 끝날 때까지 기다려야 하므로 먼저 그림
+  if (full || shift > 0) drawGraphLabels(axis, full);
+
+  // 4. 완성된 스프라이트를 실제 화면의 지정된 위치에 전송 (DMA, 나머지는 loop 에서 graphFlushPump)
+  drawGraphModeTag();
+  uint32_t composeUs = (full ? graphScroll.composeUs : 0) + (micros() - startUs);
+  graphFlushBegin(full ? graphScroll.composeStartUs : startUs, composeUs);
+  return graphScroll.dataCol == graphEnv[displayHoursIndex].lastCol;
+}
+
+
+
+// [추가] 그래프 스프라이트 생성 (화면 회전 시 크기 변경)
+void createGraphSprite() {
+  graphFlushCancel();
+  graphSprite.deleteSprite();
 
-  // 4. 라벨과 외곽선은 스프라이트 바깥이므로 기존 tft 객체로 그림
-  drawGraphLabels(axis);
+  uint32_t heapBefore = ESP.getFreeHeap();
+  graphSprite.setColorDepth(GRAPH_SPRITE_BPP);                  // [수정] 4비트 팔레트 (기본) 또는 16비트 컬러
+  graphSprite.createSprite(layout->graph_w, layout->graph_h);     // 그래프 크기만큼 생성
+#if GRAPH_SPRITE_BPP == 4
+  uint16_t palette[16] = { 0 };
+  for (int i = 0; i < NUM_GRAPH_COLORS; i++) palette[i] = graphPalette[i];
+  graphSprite.createPalette(palette, 16);
+#endif
+  graphSpriteBytes = heapBefore - ESP.getFreeHeap();
+  graphSpriteReclaimedBytes = (int32_t)layout->graph_w * layout->graph_h * 2 - (int32_t)graphSpriteBytes;
+  Serial.printf("[graph] sprite %dx%d @%dbpp: %lu bytes (reclaimed %ld vs 16bpp), free heap %lu\n",
+                layout->graph_w, layout->graph_h, GRAPH_SPRITE_BPP, (unsigned long)graphSpriteBytes,
+                (long)graphSpriteReclaimedBytes, (unsigned long)ESP.getFreeHeap());
+
+  graphSprite.setScrollRect(0, 0, layout->graph_w, layout->graph_h, graphColor(GC_BG));
+  buildGraphPairLut();
+  allocGraphStrips();
+  updateGraphYScale();
+  rebuildGraphEnvelopes();                                      // 그래프 폭이 바뀌면 컬럼 매핑도 바뀜
+  histCacheClear();                                             // [추가] 히스토리 페이지도 컬럼 단위
+  if (histView.active) histClampView();
+  invalidateGraph();
 }
 
 
 
 
 
-void handleEncoderRotation() {
+// =========================================
+// [추가] 화면 갱신 스케줄러 (loop 1회당 시간 예산)
+// =========================================
+// 12초 그래프, 1초 정보줄/얼굴/아이콘, 0.1초 바람개비, 엔코더 아이콘 갱신이 같은 loop() 에 겹치면 수십 ms 를 막음
+// -> 그리기를 바로 하지 않고 작업 비트로 요청만 해 두고, loop() 끝에서 우선순위 순서로 예산 안에서만 실행
+//    예산이 모자라면 다음 loop 로 미룸 (같은 작업을 여러 번 요청해도 한 번만 그림)
+//    그래프 합성은 이전 프레임 DMA 전송이 끝난 뒤에만 시작 (전송은 graphFlushPump 가 스트립 단위로 나눠서 처리)
+#define UI_LOOP_BUDGET_US 6000          // loop() 1회에서 화면 작업에 쓸 수 있는 시간
+#define UI_MAX_DEFER_LOOPS 8            // 이만큼 밀린 작업은 예산과 무관하게 실행 (기아 방지)
+
+enum UiJob {                            // 번호가 낮을수록 먼저
+  UJ_ICONS,                             // 엔코더/상태 아이콘 (사용자 입력에 대한 반응)
+  UJ_READOUTS,                          // 시계/온도/습도
+  UJ_FACE,
+  UJ_FAN,                               // 바람개비 애니메이션 (밀리면 프레임 하나 건너뜀)
+  UJ_GRAPH,
+  NUM_UI_JOBS
+};
+
+struct UiJobStat {
+  const char* name;
+  uint32_t estUs = 0;                   // 예상 소요시간 (최근 실행시간 이동평균)
+  uint32_t maxUs = 0;
+  uint32_t runs = 0, deferrals = 0;
+  uint8_t deferLoops = 0;               // 연속으로 밀린 loop 수
+};
+
+UiJobStat uiJobs[NUM_UI_JOBS] = {
+  { "icons" }, { "readouts" }, { "face" }, { "fan" }, { "graph" },
+};
+uint8_t uiPendingJobs = 0;
+
+void uiRequest(UiJob job) {
+  uiPendingJobs |= 1 << job;
+}
+
+// budgetUs: 이번 loop 에 남은 화면 예산 (실시간 그래프의 전체 다시 그리기는 여기서 멈추고 다음 loop 에서 이어서)
+void uiRunJob(int job, uint32_t budgetUs) {
+  switch (job) {
+    case UJ_ICONS:    drawStatusIcons(); break;
+    case UJ_READOUTS: { CageState st = readState(); drawTimeTempHumi(st.temp, st.humi); break; }
+    case UJ_FACE:     drawConditionFace(); break;
+    case UJ_FAN:
+      if (fanMode != OFF && (readState().act & ACT_FAN)) {
+        drawSpinningFan(layout->icon_x_start + 3 * layout->icon_gap, layout->icons_y + 6 + 2, TFT_GREEN);   // 4번째 아이콘 칸
+      }
+      break;
+    case UJ_GRAPH:
+      if (!histView.active) { if (!drawGraph(budgetUs)) uiRequest(UJ_GRAPH); }
+      else if (histView.dirty) drawHistoryGraph();             // 히스토리 화면은 이동/확대 시에만
+      break;
+  }
+}
+
+// loop() 에서 매번 호출: 요청된 작업을 우선순위대로 예산 안에서 실행
+void uiSchedule(unsigned long loopStartUs) {
+  if (sysInfoDisplayUntil > 0) { uiPendingJobs = 0; return; }  // 정보창이 닫힐 때 전체 다시 그림
+
+  bool ranAny = false;
+  for (int job = 0; job < NUM_UI_JOBS && uiPendingJobs; job++) {
+    if (!(uiPendingJobs & (1 << job))) continue;
+    UiJobStat &st = uiJobs[job];
+
+    uint32_t elapsed = micros() - loopStartUs;
+    bool starving = st.deferLoops >= UI_MAX_DEFER_LOOPS;
+    bool blocked = (job == UJ_GRAPH && graphFlush.active);     // 이전 그래프 프레임 전송 중
+    bool sliced = job == UJ_GRAPH && !histView.active;          // [추가] 예산이 남은 만큼만 그리고 멈춤
+    bool fits = !ranAny || elapsed + st.estUs <= UI_LOOP_BUDGET_US || (sliced && elapsed < UI_LOOP_BUDGET_US);
+    if (!starving && (blocked || !fits)) {
+      st.deferLoops++;
+      st.deferrals++;
+      continue;
+    }
+
+    uiPendingJobs &= ~(1 << job);
+    unsigned long t0 = micros();
+    uiRunJob(job, elapsed < UI_LOOP_BUDGET_US ? UI_LOOP_BUDGET_US - elapsed : 1);   // 기아 방지로 넘친 경우도 한 조각은 그림
+    uint32_t us = micros() - t0;
+    st.estUs = st.runs ? (st.estUs * 3 + us) / 4 : us;
+    if (us > st.maxUs) st.maxUs = us;
+    st.runs++;
+    st.deferLoops = 0;
+    ranAny = true;
+  }
+}
+
+
+
+// =========================================
+// [추가] 엔코더/버튼 입력: ISR + 디바운스 타이머 -> 입력 이벤트 큐
+// =========================================
+// loop() 에서 CLK/DT 를 한 번씩 읽으면 handleClient, 플래시 기록, drawGraph 가 길어질 때 단계가 빠짐
+// -> CLK/DT 변화마다 GPIO 인터럽트에서 직교 신호를 해석해 (안정되면) 큐에 넣고, loop 는 쌓인 이벤트를 한꺼번에 처리
+// [수정] ISR 은 에지마다 전이표를 적용하고 lastEncState 를 갱신 (에지를 버리면 다음 에지가 엉뚱한 전이로 읽힘)
+//        단계는 바로 큐에 넣지 않고 encPending 에 모아 두고, 입력 타이머가 마지막 에지 뒤 ENC_STABLE_US 동안
+//        상태가 그대로였을 때만 합계를 이벤트로 보냄 -> 접점 튐의 +1/-1 쌍은 합계에서 0 이 되어 큐에 닿지 않음
+//        상쇄된 에지와 두 비트가 동시에 바뀐 전이 (방향 모름) 는 encGlitches
+// 버튼: ENC_BTN_SAMPLE_MS 주기 esp_timer 로 샘플링, ENC_BTN_STABLE 번 연속 같은 값이면 눌림/뗌 이벤트
+#define ENC_BTN_SAMPLE_MS   5
+#define ENC_BTN_STABLE      4                   // 4 x 5ms = 20ms
+#define ENC_STABLE_US       1500                // 엔코더 접점 튐은 보통 1ms 이내
+#define INPUT_QUEUE_LEN     32
+
+enum InputEventType : uint8_t { IE_ROTATE, IE_BTN_DOWN, IE_BTN_UP };
+struct InputEvent {
+  InputEventType type;
+  int8_t delta;                                 // IE_ROTATE: +1 / -1
+  uint32_t ms;                                  // 이벤트 시각 (버튼 판정용)
+};
+
+QueueHandle_t inputQueue = nullptr;
+esp_timer_handle_t btnTimer = nullptr;
+volatile int32_t encOverflowDelta = 0;          // 큐가 가득 찼을 때 모아 둔 단계 (loop 에서 합침)
+volatile int32_t encPending = 0;                // [추가] 아직 안정되지 않은 단계 합 (ISR 이 모음)
+volatile uint32_t encPendingEdges = 0;          // [추가] 그 사이 방향이 있는 에지 수
+volatile uint32_t encLastEdgeUs = 0;            // [추가] 마지막 에지 시각
+volatile uint32_t encSteps = 0, encGlitches = 0, btnEvents = 0;
+volatile uint32_t btnDrops = 0;                 // [추가] 큐가 가득 차서 못 넣은 버튼 이벤트 (다음 샘플에서 다시 보냄)
+portMUX_TYPE encMux = portMUX_INITIALIZER_UNLOCKED;
+
+// 이전 상태(2비트) x 현재 상태(2비트) -> +1 / -1 / 0 (변화 없음 또는 두 비트 동시 변화)
+const int8_t ENC_TRANSITION[16] = {
+   0, +1, -1,  0,
+  -1,  0,  0, +1,
+  +1,  0,  0, -1,
+   0, -1, +1,  0,
+};
+
+void IRAM_ATTR encoderIsr() {
   uint8_t encState = (digitalRead(ENCODER_CLK) << 1) | digitalRead(ENCODER_DT);
   if (encState == lastEncState) return;
-  int delta = 0;
-  if ((lastEncState == 0b00 && encState == 0b01) || (lastEncState == 0b01 && encState == 0b11) ||
-      (lastEncState == 0b11 && encState == 0b10) || (lastEncState == 0b10 && encState == 0b00)) {
-    delta = +1;
-  } else if ((lastEncState == 0b00 && encState == 0b10) || (lastEncState == 0b10 && encState == 0b11) ||
-             (lastEncState == 0b11 && encState == 0b01) || (lastEncState == 0b01 && encState == 0b00)) {
-    delta = -1;
-  }
-  if (delta != 0) {
+
+  int8_t delta = ENC_TRANSITION[(lastEncState << 2) | encState];
+  lastEncState = encState;
+  portENTER_CRITICAL_ISR(&encMux);
+  encLastEdgeUs = micros();
+  if (delta == 0) encGlitches++;
+  else { encPending += delta; encPendingEdges++; }
+  portEXIT_CRITICAL_ISR(&encMux);
+}
+
+// [추가] 입력 타이머에서: 마지막 에지 뒤 ENC_STABLE_US 동안 조용했으면 모아 둔 단계를 이벤트 하나로 보냄
+// 돌리는 중에는 에지 사이 간격이 보통 ENC_STABLE_US 보다 길어 거의 매 샘플 보냄
+void encCommitStable() {
+  portENTER_CRITICAL(&encMux);
+  bool stable = encPendingEdges > 0 && (uint32_t)micros() - encLastEdgeUs >= ENC_STABLE_US;
+  int32_t net = stable ? encPending : 0;
+  if (stable) {
+    uint32_t kept = (uint32_t)abs(net);
+    encGlitches += encPendingEdges - kept;                      // +1/-1 로 상쇄된 에지
+    encSteps += kept;
+    encPending = 0;
+    encPendingEdges = 0;
+  }
+  portEXIT_CRITICAL(&encMux);
+  if (net == 0) return;
+
+  InputEvent ev = { IE_ROTATE, (int8_t)constrain(net, -127, 127), 0 };
+  if (ev.delta != net || xQueueSend(inputQueue, &ev, 0) != pdTRUE) {
+    portENTER_CRITICAL(&encMux);
+    encOverflowDelta += net;
+    portEXIT_CRITICAL(&encMux);
+  }
+  if (loopTaskHandle) xTaskNotifyGive(loopTaskHandle);         // [추가] 잠든 loop() 깨우기
+}
+
+// esp_timer 태스크에서 실행 (ISR 아님)
+void btnTimerCb(void*) {
+  encCommitStable();                                            // [추가] 엔코더 글리치 필터
+  static bool stable = HIGH;
+  static uint8_t count = 0;
+  bool raw = digitalRead(ENCODER_SW);
+  if (raw == stable) { count = 0; return; }
+  if (++count < ENC_BTN_STABLE) return;
+  count = 0;
+  InputEvent ev = { raw == LOW ? IE_BTN_DOWN : IE_BTN_UP, 0, (uint32_t)millis() };
+  if (xQueueSend(inputQueue, &ev, 0) != pdTRUE) {   // [수정] 큐가 가득 참 -> stable 을 그대로 두어 다음 판정에서 다시 보냄
+    btnDrops++;
+    return;
+  }
+  stable = raw;
+  btnEvents++;
+  if (loopTaskHandle) xTaskNotifyGive(loopTaskHandle);         // [추가] 잠든 loop() 깨우기
+}
+
+void startInputIsr() {
+  inputQueue = xQueueCreate(INPUT_QUEUE_LEN, sizeof(InputEvent));
+  lastEncState = (digitalRead(ENCODER_CLK) << 1) | digitalRead(ENCODER_DT);
+  attachInterrupt(digitalPinToInterrupt(ENCODER_CLK), encoderIsr, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(ENCODER_DT),  encoderIsr, CHANGE);
+
+  esp_timer_create_args_t args = {};
+  args.callback = btnTimerCb;
+  args.name = "btn";
+  esp_timer_create(&args, &btnTimer);
+  esp_timer_start_periodic(btnTimer, ENC_BTN_SAMPLE_MS * 1000ULL);
+}
+
+
+// [수정] 엔코더 회전 처리: loop 에서 모은 단계 합계를 한 번에 반영 (빠르게 돌려도 그리기는 한 번)
+void handleEncoderRotation(int delta) {
+  if (delta != 0 && histView.active) {
+    histPan(delta * ENCODER_DIR);                     // [추가] 히스토리 화면에서는 시간 이동
+  } else if (delta != 0) {
     brightnessStep[selectedLED] += delta * ENCODER_DIR;
     brightnessStep[selectedLED] = constrain(brightnessStep[selectedLED], 0, BRIGHTNESS_STEPS);
     pwmValue[0] = stepToPWM(brightnessStep[0]);
     pwmValue[1] = stepToPWM(brightnessStep[1]);
     ledcWrite(0, pwmValue[0]); ledcWrite(1, pwmValue[1]);
 
-    drawStatusIcons();
+    uiRequest(UJ_ICONS);                              // [수정] 빠르게 돌려도 loop 1회에 한 번만 그림
 
   }
-  lastEncState = encState;
 }
 
 
 void lcdPrint(const char* msg) {
+    tftSync();
     tft.setTextSize(2);
     tft.setTextColor(TFT_WHITE, BG_COLOR);
     tft.setCursor(50, 100);
@@ -1246,17 +2427,332 @@ void lcdPrint(const char* msg) {
 
 void updateGraphTimeScale() {
     displayHours = displayHoursOptions[displayHoursIndex];
-    labelScrollIntervalMs = (displayHours * 3600UL * 1000UL) / layout_graph_w;
-    secondsPerPixel = (float)(displayHours * 3600) / layout_graph_w;
+    labelScrollIntervalMs = (displayHours * 3600UL * 1000UL) / layout->graph_w;
+    secondsPerPixel = (float)(displayHours * 3600) / layout->graph_w;
+    rebuildGraphRange();                                         // [추가] Y축 자동 조정은 현재 모드 기준
+    invalidateGraph();
+}
+
+
+
+void changeGraphMode() {
+   displayHoursIndex = (displayHoursIndex + 1) % NUM_GRAPH_MODES;
+   updateGraphTimeScale();
+   uiRequest(UJ_GRAPH);
+}
+
+
+// =========================================
+// [추가] 히스토리 화면 (엔코더로 /log.bin 이동/확대)
+// =========================================
+// 버튼 3번 클릭: 히스토리 화면 시작/종료 (HIST_IDLE_MS 동안 입력이 없으면 자동 종료)
+// 엔코더 회전: HIST_PAGE_COLS 컬럼씩 과거/현재 방향 이동, 클릭: 1H/6H/12H/24H 확대/축소 (가운데 시각 유지)
+// 플래시 레코드를 (모드, 페이지) 단위 컬럼 min/max 로 요약해 HIST_CACHE_PAGES 개까지 LRU 캐시
+// -> 그리기는 캐시된 페이지만 읽고, 화면 좌우의 다음 페이지는 loop() 마다 HIST_CHUNK_RECORDS 개씩 미리 읽어 둠
+//    (min/max 누적이므로 읽는 도중 레코드가 추가되어 같은 레코드를 두 번 읽어도 결과는 같음)
+#define HIST_PAGE_COLS 69                   // LANDSCAPE 폭(276)의 1/4 = 엔코더 1칸 이동량
+#define HIST_CACHE_PAGES 8                  // 화면(최대 5페이지) + 좌우 1페이지씩 + 여유
+#define HIST_CHUNK_RECORDS 64               // loop() 1회에 읽는 레코드 수 (512 bytes)
+#define HIST_IDLE_MS 60000
+
+struct HistCol {
+  int16_t tMin, tMax, tLast;                // tLast: 다음 컬럼으로 이어지는 값
+  int16_t hMin, hMax, hLast;
+  uint8_t act;                              // [추가] 액추에이터 (ACT_* OR)
+};
+
+enum HistPageState : uint8_t { HP_EMPTY, HP_LOADING, HP_READY };
+
+struct HistPage {
+  uint8_t state;
+  uint8_t mode;
+  bool partial;                             // 현재 시각을 포함 -> 새 레코드가 들어오면 다시 읽음
+  uint32_t page;                            // 절대 컬럼 / HIST_PAGE_COLS
+  uint32_t nextIdx;                         // 다음에 읽을 논리 인덱스 (0 = 가장 오래된 레코드)
+  uint32_t endTs;                           // 이 시각 이후 레코드가 나오면 로딩 끝
+  uint32_t lastUse;
+  unsigned long loadedMs;
+  HistCol cols[HIST_PAGE_COLS];
+};
+HistPage histPages[HIST_CACHE_PAGES];
+
+void histCacheClear() {
+  for (int i = 0; i < HIST_CACHE_PAGES; i++) histPages[i].state = HP_EMPTY;
+}
+
+// 논리 인덱스 (0 = 가장 오래된 레코드) -> 파일 내 레코드 위치
+uint32_t histPhysIndex(uint32_t i) {
+  return (logMeta.head_index + FLASH_MAX_RECORDS - logMeta.record_count + i) % FLASH_MAX_RECORDS;
+}
+
+bool histReadAt(File &f, uint32_t i, LogRecord &rec) {
+  f.seek(histPhysIndex(i) * sizeof(LogRecord));
+  return f.read((uint8_t*)&rec, sizeof(LogRecord)) == sizeof(LogRecord);
+}
+
+// ts 이상인 첫 레코드의 논리 인덱스 (레코드는 시간순)
+uint32_t histLowerBound(File &f, uint32_t ts) {
+  uint32_t lo = 0, hi = logMeta.record_count;
+  LogRecord rec;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (histReadAt(f, mid, rec) && rec.ts < ts) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+void histPageBegin(HistPage &p, File &f) {
+  uint32_t windowSec = graphWindowSec(p.mode);
+  uint32_t col0 = p.page * HIST_PAGE_COLS;
+  for (int i = 0; i < HIST_PAGE_COLS; i++) {
+    HistCol &c = p.cols[i];
+    c.tMin = c.tMax = c.tLast = c.hMin = c.hMax = c.hLast = INVALID_VALUE;
+    c.act = 0;
+  }
+  p.endTs = graphColumnStartTsFor(col0 + HIST_PAGE_COLS, windowSec);
+  p.nextIdx = histLowerBound(f, graphColumnStartTsFor(col0, windowSec));
+  p.state = HP_LOADING;
+}
+
+void histAccumulate(int16_t v, int16_t &mn, int16_t &mx, int16_t &last) {
+  if (v == INVALID_VALUE) return;
+  if (mn == INVALID_VALUE || v < mn) mn = v;
+  if (mx == INVALID_VALUE || v > mx) mx = v;
+  last = v;
+}
+
+// 레코드 최대 HIST_CHUNK_RECORDS 개를 읽어 페이지에 누적, 페이지가 끝나면 true
+bool histPageStep(HistPage &p, File &f) {
+  if (p.state == HP_EMPTY) histPageBegin(p, f);
+
+  LogRecord buf[HIST_CHUNK_RECORDS];
+  uint32_t n = min((uint32_t)HIST_CHUNK_RECORDS, logMeta.record_count - min(p.nextIdx, logMeta.record_count));
+  uint32_t phys = histPhysIndex(p.nextIdx);
+  n = min(n, FLASH_MAX_RECORDS - phys);                         // 링 끝에서 끊어 읽음
+  if (n > 0) {
+    f.seek(phys * sizeof(LogRecord));
+    n = f.read((uint8_t*)buf, n * sizeof(LogRecord)) / sizeof(LogRecord);
+  }
+
+  uint32_t windowSec = graphWindowSec(p.mode);
+  uint32_t col0 = p.page * HIST_PAGE_COLS;
+  bool done = (n == 0);
+  for (uint32_t i = 0; i < n && !done; i++) {
+    const LogRecord &rec = buf[i];
+    p.nextIdx++;
+    if (rec.ts == 0 || rec.ts == 0xFFFFFFFF) continue;
+    if (rec.ts >= p.endTs) { done = true; break; }
+    uint32_t col = graphColumnFor(rec.ts, windowSec);
+    if (col < col0 || col >= col0 + HIST_PAGE_COLS) continue;
+    HistCol &c = p.cols[col - col0];
+    histAccumulate(rec.temp, c.tMin, c.tMax, c.tLast);
+    histAccumulate(recHumi(rec), c.hMin, c.hMax, c.hLast);
+    c.act |= recActuators(rec);
+  }
+  if (p.nextIdx >= logMeta.record_count) done = true;
+
+  if (done) {
+    p.state = HP_READY;
+    p.partial = p.endTs > (uint32_t)time(nullptr);
+    p.loadedMs = millis();
+  }
+  return done;
+}
+
+HistPage* histFindPage(uint8_t mode, uint32_t page) {
+  for (int i = 0; i < HIST_CACHE_PAGES; i++) {
+    HistPage &p = histPages[i];
+    if (p.state != HP_EMPTY && p.mode == mode && p.page == page) return &p;
+  }
+  return nullptr;
+}
+
+// 캐시에서 찾거나 가장 오래 안 쓴 슬롯을 비워서 줌 (상태는 HP_EMPTY -> 첫 step 에서 로딩 시작)
+HistPage* histAcquirePage(uint8_t mode, uint32_t page) {
+  HistPage* p = histFindPage(mode, page);
+  if (p) {
+    // 현재 시각을 포함한 페이지는 새 샘플이 쌓였으면 다시 읽음
+    if (p->state == HP_READY && p->partial && millis() - p->loadedMs >= GRAPH_SAMPLE_INTERVAL_SEC * 1000UL) p->state = HP_EMPTY;
+    return p;
+  }
+  HistPage* victim = &histPages[0];
+  for (int i = 0; i < HIST_CACHE_PAGES; i++) {
+    HistPage &c = histPages[i];
+    if (c.state == HP_EMPTY) { victim = &c; break; }
+    if (c.lastUse < victim->lastUse) victim = &c;
+  }
+  victim->state = HP_EMPTY;
+  victim->mode = mode;
+  victim->page = page;
+  victim->lastUse = histView.useClock;
+  return victim;
+}
+
+// 그릴 때 필요한 페이지: 준비돼 있지 않으면 여기서 끝까지 읽음 (멈춤 시간 기록)
+HistPage* histEnsurePage(uint8_t mode, uint32_t page) {
+  HistPage* p = histAcquirePage(mode, page);
+  p->lastUse = histView.useClock;
+  if (p->state == HP_READY) { histView.hits++; return p; }
+
+  histView.misses++;
+  unsigned long t0 = micros();
+  File f = LittleFS.open(LOG_FILE, "r");
+  if (!f) { p->state = HP_READY; p->partial = true; p->loadedMs = millis(); return p; }
+  while (!histPageStep(*p, f)) {}
+  f.close();
+  uint32_t us = micros() - t0;
+  histView.stallUs += us;
+  if (us > histView.stallMaxUs) histView.stallMaxUs = us;
+  return p;
+}
+
+uint32_t histLiveRightCol() {
+  return graphColumnOf((uint32_t)time(nullptr));
+}
+
+void histClampView() {
+  uint32_t liveRight = histLiveRightCol();
+  uint32_t minRight = histView.oldestTs ? graphColumnOf(histView.oldestTs) + layout->graph_w / 2 : 0;   // 가장 오래된 데이터가 화면 가운데까지
+  if (histView.rightCol < minRight) histView.rightCol = minRight;
+  if (histView.rightCol > liveRight) histView.rightCol = liveRight;
+}
+
+void histEnter() {
+  if (!timeSynced || logMeta.record_count == 0) return;
+  LogRecord rec;
+  File f = LittleFS.open(LOG_FILE, "r");
+  histView.oldestTs = (f && histReadAt(f, 0, rec)) ? rec.ts : 0;
+  if (f) f.close();
+
+  histView.active = true;
+  histView.rightCol = histLiveRightCol();
+  histView.lastInputMs = millis();
+  histView.dirty = true;
+  uiRequest(UJ_GRAPH);
+}
+
+void histExit() {
+  if (!histView.active) return;
+  histView.active = false;
+  invalidateGraph();                                            // 실시간 그래프 전체 다시 그림
+  uiRequest(UJ_GRAPH);
+}
+
+// steps > 0 : 현재 방향, < 0 : 과거 방향
+void histPan(int steps) {
+  int64_t col = (int64_t)histView.rightCol + (int64_t)steps * HIST_PAGE_COLS;
+  histView.rightCol = (col < 0) ? 0 : (uint32_t)col;
+  histClampView();
+  histView.lastInputMs = millis();
+  histView.dirty = true;
+  uiRequest(UJ_GRAPH);
+}
+
+// 1H -> 6H -> 12H -> 24H -> 1H, 화면 가운데 시각 유지
+void histZoom() {
+  uint32_t centerTs = graphColumnStartTs(histView.rightCol - min(histView.rightCol, (uint32_t)layout->graph_w / 2));
+  displayHoursIndex = (displayHoursIndex + 1) % NUM_GRAPH_MODES;
+  updateGraphTimeScale();
+  histView.rightCol = graphColumnOf(centerTs) + layout->graph_w / 2;
+  histClampView();
+  histView.lastInputMs = millis();
+  histView.dirty = true;
+  uiRequest(UJ_GRAPH);
+}
+
+// loop() 에서 매번 호출: 화면 좌우의 다음 페이지(과거 쪽 먼저)를 HIST_CHUNK_RECORDS 개씩 미리 읽음
+void histPrefetchPump() {
+  if (!histView.active) return;
+  if (millis() - histView.lastInputMs > HIST_IDLE_MS) { histExit(); return; }
+
+  uint32_t firstPage = (histView.rightCol >= (uint32_t)(layout->graph_w - 1) ? histView.rightCol - (layout->graph_w - 1) : 0) / HIST_PAGE_COLS;
+  uint32_t lastPage = histView.rightCol / HIST_PAGE_COLS;
+  uint32_t wanted[2] = { firstPage > 0 ? firstPage - 1 : firstPage, lastPage + 1 };
+  bool wantRight = histView.rightCol < histLiveRightCol();
+
+  for (int i = 0; i < 2; i++) {
+    if (i == 0 && firstPage == 0) continue;
+    if (i == 1 && !wantRight) continue;
+    HistPage* p = histAcquirePage(displayHoursIndex, wanted[i]);
+    if (p->state == HP_READY) continue;
+    p->lastUse = histView.useClock;
+    File f = LittleFS.open(LOG_FILE, "r");
+    if (!f) return;
+    if (histPageStep(*p, f)) histView.prefetches++;
+    f.close();
+    return;                                                     // loop() 1회에 한 덩어리만
+  }
+}
+
+// 히스토리 화면 그리기: 캐시된 페이지로 전체 다시 그림 (스크롤 상태는 실시간 그래프 복귀 시 무효)
+void drawHistoryGraph() {
+  unsigned long composeStartUs = micros();
+  TimeAxisState axis;
+  computeTimeAxis(axis);
+  axis.rightCol = histView.rightCol;
+  uint32_t leftCol = graphLeftCol(axis);
+
+  histView.useClock++;
+  HistPage* pages[HIST_CACHE_PAGES];
+  uint32_t firstPage = leftCol / HIST_PAGE_COLS;
+  uint32_t numPages = axis.rightCol / HIST_PAGE_COLS - firstPage + 1;
+  for (uint32_t i = 0; i < numPages; i++) pages[i] = histEnsurePage(displayHoursIndex, firstPage + i);
+
+  // Y축: 화면 안 컬럼의 min/max (계열별)
+  int16_t lo[NUM_GRAPH_SERIES] = { INVALID_VALUE, INVALID_VALUE }, hi[NUM_GRAPH_SERIES] = { INVALID_VALUE, INVALID_VALUE };
+  for (uint32_t c = leftCol; c <= axis.rightCol; c++) {
+    const HistCol &e = pages[c / HIST_PAGE_COLS - firstPage]->cols[c % HIST_PAGE_COLS];
+    int16_t mn[NUM_GRAPH_SERIES] = { e.tMin, e.hMin }, mx[NUM_GRAPH_SERIES] = { e.tMax, e.hMax };
+    for (int s = 0; s < NUM_GRAPH_SERIES; s++) {
+      if (mn[s] == INVALID_VALUE) continue;
+      if (lo[s] == INVALID_VALUE || mn[s] < lo[s]) lo[s] = mn[s];
+      if (hi[s] == INVALID_VALUE || mx[s] > hi[s]) hi[s] = mx[s];
+    }
+  }
+  graphYAxisFit(lo, hi);
+
+  graphSprite.fillSprite(graphColor(GC_BG));
+  drawGraphGrid(axis, leftCol, axis.rightCol);
+  const HistCol* prev = nullptr;
+  for (uint32_t c = leftCol; c <= axis.rightCol; c++) {
+    const HistCol &e = pages[c / HIST_PAGE_COLS - firstPage]->cols[c % HIST_PAGE_COLS];
+    int x = graphColumnX(axis, c);
+    drawActuatorBands(x, e.act);
+    drawEnvelopeSpan(GS_TEMP, x, e.tMin, e.tMax, prev ? prev->tLast : (int16_t)INVALID_VALUE, graphColor(GC_TEMP));
+    drawEnvelopeSpan(GS_HUMI, x, e.hMin, e.hMax, prev ? prev->hLast : (int16_t)INVALID_VALUE, graphColor(GC_HUMI));
+    prev = (e.tMin != INVALID_VALUE || e.hMin != INVALID_VALUE) ? &e : nullptr;
+  }
+
+  drawGraphLabels(axis, true);
+  drawGraphModeTag(TFT_ORANGE);
+  graphFlushBegin(composeStartUs, micros() - composeStartUs);
+
+  graphScroll.valid = false;
+  graphScroll.composing = false;
+  histView.dirty = false;
+}
+
+
+
+// [추가] screenRotation 을 화면에 적용하고 전체 다시 그림 (설정 저장, 렌더 벤치)
+void applyScreenRotation() {
+  updateLayout(); 
+  tft.setRotation(screenRotation); 
+  tftSync();
+  tft.fillScreen(BG_COLOR); 
+  invalidateWidgets();
+  createGraphSprite();
+  drawTitle();
+  updateGraphTimeScale();
+  drawGraphFrame();
+  drawGraph();
+  drawConditionFace();
+  drawStatusIcons();
 }
 
 
 
-void changeGraphMode() {
-   displayHoursIndex = (displayHoursIndex + 1) % NUM_GRAPH_MODES;
-   updateGraphTimeScale();
-   drawGraph();
-}
 
 
 /*
@@ -1278,18 +2774,134 @@ void setHumidifierHwToggle() {
 
 
 
+// =========================================
+// [추가] 마감시각 스케줄러 (태스크마다 하나, 그 태스크 안에서만 사용)
+// =========================================
+// loop 마다 millis() 비교를 전부 다시 하는 대신, 작업마다 다음 마감시각을 두고 마감이 지난 작업만 마감 순으로 실행
+// schedRun() 은 다음 마감까지 남은 시간(쉬어도 되는 시간)을 돌려줌 -> controlTask 는 그만큼 큐에서 대기
+// 시각 비교는 (int32_t)(due - now) 부호로 하므로 millis() 가 49.7일마다 0 으로 돌아가도 순서가 유지됨 (간격 < 24.8일)
+#define SCHED_IDLE_MAX_MS 1000                  // 예약된 작업이 없을 때 최대 대기 (와치독 리셋 주기)
+
+typedef void (*SchedFn)();
+struct SchedJob {
+  const char* name;
+  SchedFn fn;
+  uint32_t periodMs;                            // 0 = 한 번만 (schedArm 으로 다시 예약)
+  uint32_t due;
+  bool armed;
+  uint32_t runs;
+  uint32_t lateMaxMs;                           // 마감보다 늦게 실행된 최대 시간
+};
+
+struct Scheduler {
+  SchedJob* jobs;
+  uint8_t count;
+  uint32_t idleMs;                              // 마지막 schedRun 에서 계산한 다음 마감까지 남은 시간
+};
+
+bool schedDue(uint32_t due, uint32_t now) { return (int32_t)(due - now) <= 0; }
+
+void schedArm(Scheduler &s, int id, uint32_t due) {
+  s.jobs[id].due = due;
+  s.jobs[id].armed = true;
+}
+
+void schedDisarm(Scheduler &s, int id) { s.jobs[id].armed = false; }
+
+// 주기 작업을 지금부터 시작 (첫 실행은 firstDelayMs 뒤)
+void schedStart(Scheduler &s, uint32_t now, uint32_t firstDelayMs = 0) {
+  for (int i = 0; i < s.count; i++) {
+    if (s.jobs[i].periodMs) schedArm(s, i, now + firstDelayMs);
+  }
+}
+
+// 마감이 지난 작업을 마감이 이른 순으로 실행 (작업 수가 적어 선형 탐색), 다음 마감까지 남은 ms 반환
+uint32_t schedRun(Scheduler &s, uint32_t now) {
+  for (int pass = 0; pass < s.count; pass++) {
+    int next = -1;
+    for (int i = 0; i < s.count; i++) {
+      const SchedJob &j = s.jobs[i];
+      if (!j.armed || !schedDue(j.due, now)) continue;
+      if (next < 0 || (int32_t)(j.due - s.jobs[next].due) < 0) next = i;
+    }
+    if (next < 0) break;
+
+    SchedJob &j = s.jobs[next];
+    uint32_t late = now - j.due;
+    if (late > j.lateMaxMs) j.lateMaxMs = late;
+    if (j.periodMs) {
+      j.due += j.periodMs;
+      if (schedDue(j.due, now)) j.due = now + j.periodMs;      // 여러 주기를 놓쳤으면 몰아서 실행하지 않음
+    } else {
+      j.armed = false;
+    }
+    j.runs++;
+    j.fn();                                                     // 안에서 자기 자신을 다시 예약할 수 있음
+    now = millis();
+  }
+
+  uint32_t idle = SCHED_IDLE_MAX_MS;
+  for (int i = 0; i < s.count; i++) {
+    const SchedJob &j = s.jobs[i];
+    if (!j.armed) continue;
+    int32_t left = (int32_t)(j.due - now);
+    if (left <= 0) { idle = 0; break; }
+    if ((uint32_t)left < idle) idle = left;
+  }
+  s.idleMs = idle;
+  return idle;
+}
+
+
+
+// [추가] controlTask 스케줄 작업
+enum CtlJob { CJ_SAMPLE, CJ_SENSOR_COLLECT, CJ_GRAPH_SAMPLE, CJ_AUTO_OFF, CJ_HUMI_SEQ, NUM_CTL_JOBS };
+void ctlJobSample();
+void ctlJobSensorCollect();
+void ctlJobGraphSample();
+void ctlJobAutoOff();
+void ctlJobHumiSeq();
+SchedJob ctlJobs[NUM_CTL_JOBS] = {
+  { "sample",         ctlJobSample,        SAMPLE_INTERVAL,                   0, false, 0, 0 },   // 센서 측정 시작
+  { "sensor_collect", ctlJobSensorCollect, 0,                                 0, false, 0, 0 },   // 변환 시간 뒤 결과 읽기 -> 제어
+  { "graph_sample",   ctlJobGraphSample,   GRAPH_SAMPLE_INTERVAL_SEC * 1000UL, 0, false, 0, 0 },
+  { "auto_off",       ctlJobAutoOff,       0,                                 0, false, 0, 0 },   // 수동 ON 중 가장 이른 자동꺼짐 시각
+  { "humi_seq",       ctlJobHumiSeq,       0,                                 0, false, 0, 0 },   // 가습기 전원 -> 버튼 누름 -> 뗌 다음 단계
+};
+Scheduler ctlSched = { ctlJobs, NUM_CTL_JOBS, 0 };
+
+// [수정] 가습기 ON 시퀀스 (전원 -> 100ms -> RUN 버튼 누름 -> 100ms -> 뗌) 를 delay() 없이 ctlSched 로 진행
+// 꺼져 있다가 켜질 때만 시작하므로 ON 유지 중에 매초 humidifierOn() 이 불려도 버튼을 다시 누르지 않음
+#define HUMI_SEQ_STEP_MS 100
+
+enum HumiSeqState : uint8_t { HS_OFF, HS_POWERING, HS_PRESSING, HS_ON };
+HumiSeqState humiSeq = HS_OFF;
+uint32_t humiSeqStarts = 0;                      // 실제 꺼짐 -> 켜짐 전환 횟수 (/metrics)
+
+void ctlJobHumiSeq() {
+  if (humiSeq == HS_POWERING) {
+    digitalWrite(HUMIDIFIER_RUN, LOW);             // 가습기 버튼 Pressed (RUN)
+    humiSeq = HS_PRESSING;
+    schedArm(ctlSched, CJ_HUMI_SEQ, millis() + HUMI_SEQ_STEP_MS);
+  } else if (humiSeq == HS_PRESSING) {
+    digitalWrite(HUMIDIFIER_RUN, HIGH);            // 가습기 버튼 Released
+    humiSeq = HS_ON;
+  }
+}
+
 // hardware ON sequence
 void setHumidifierHwOn() {
-  //if (digitalRead(HUMIDIFIER_PWR) == HIGH) return; // Already on
+  if (humiSeq != HS_OFF) return;                  // 이미 켜졌거나 시퀀스 진행 중
   digitalWrite(HUMIDIFIER_PWR, HIGH);
-  delay(100);
-  digitalWrite(HUMIDIFIER_RUN, LOW);               // 가습기 버튼 Pressed (RUN)
-  delay(100);
-  digitalWrite(HUMIDIFIER_RUN, HIGH);              // 가습기 버튼 Released
+  humiSeq = HS_POWERING;
+  humiSeqStarts++;
+  schedArm(ctlSched, CJ_HUMI_SEQ, millis() + HUMI_SEQ_STEP_MS);
 }
 
 // hardware OFF sequence
 void setHumidifierHwOff() {
+  schedDisarm(ctlSched, CJ_HUMI_SEQ);             // 진행 중이던 시퀀스 취소
+  humiSeq = HS_OFF;
   digitalWrite(HUMIDIFIER_RUN, HIGH);              // 가습기 버튼 Released
   digitalWrite(HUMIDIFIER_PWR, LOW);               // 가습기 전원 OFF
 }
@@ -1298,6 +2910,87 @@ void setHumidifierHwOff() {
 
 
 
+// =========================================
+// [추가] 태스크 분리: 센서/제어 <-> 화면/웹
+// =========================================
+// controlTask (core 0, 높은 우선순위): 센서 측정, 릴레이 판단, 수동 ON 자동꺼짐, 그래프 샘플 평균
+// loop 태스크 (core 1): handleClient, SPI 그리기, 플래시 로그, 엔코더 -> HTTP/SPI 가 오래 걸려도 릴레이 판단은 밀리지 않음
+// loop -> 제어: ctlCmdQueue (웹에서 바꾼 모드를 바로 적용)
+// 제어 -> loop: uiEventQueue (화면 갱신 요청, 그래프 샘플, 모드 저장) + 상태 스냅샷 (readState)
+#define CONTROL_TASK_CORE   0
+#define CONTROL_TASK_PRIO   5                   // loop(1) 보다 높게, WiFi/lwIP(18~23) 보다 낮게
+#define CONTROL_TASK_STACK  6144                // bytes
+#define CTL_QUEUE_LEN       8
+#define UI_QUEUE_LEN        16
+
+enum UiEventType : uint8_t { UE_SAMPLE, UE_GRAPH_SAMPLE, UE_MODE_CHANGED };
+struct UiEvent {
+  UiEventType type;
+  uint8_t act;                                  // UE_GRAPH_SAMPLE: 구간 동안 켜졌던 액추에이터
+  float temp, humi;                             // UE_GRAPH_SAMPLE: 구간 평균
+};
+
+struct CtlCmd {
+  uint8_t actuator;                             // ACT_*
+  OperMode mode;
+};
+
+QueueHandle_t uiEventQueue = nullptr;
+QueueHandle_t ctlCmdQueue = nullptr;
+TaskHandle_t controlTaskHandle = nullptr;
+TaskHandle_t loopTaskHandle = nullptr;
+
+// 태스크별 통계 (/metrics)
+struct TaskStat {
+  uint32_t cycles = 0;
+  uint32_t maxCycleUs = 0;
+  uint32_t queueDrops = 0;                      // 받는 쪽 큐가 가득 차서 버린 메시지
+  uint64_t idleUs = 0;                          // [추가] 알림을 기다리며 잠든 시간 (loop: loopIdleWait, control: 큐 대기)
+};
+TaskStat controlTaskStat = { 0 }, loopTaskStat = { 0 };
+std::atomic<uint32_t> ctlCmdsApplied(0);        // [추가] controlTask 가 적용한 명령 수 (웹 응답 전 대기용)
+EventGroupHandle_t ctlAppliedEvents = nullptr;  // [추가] 명령을 적용할 때마다 CTL_APPLIED_BIT (ctlWaitApplied 깨우기)
+#define CTL_APPLIED_BIT (1 << 0)
+#define CTL_APPLY_TIMEOUT_MS 200
+
+void uiPost(UiEventType type, float t = NAN, float h = NAN, uint8_t act = 0) {
+  UiEvent ev = { type, act, t, h };
+  if (!uiEventQueue || xQueueSend(uiEventQueue, &ev, 0) != pdTRUE) { controlTaskStat.queueDrops++; return; }
+  xTaskNotifyGive(loopTaskHandle);                               // [추가] 잠든 loop() 깨우기 (loopIdleWait)
+}
+
+bool ctlPost(uint8_t actuator, OperMode mode) {
+  CtlCmd cmd = { actuator, mode };
+  if (!ctlCmdQueue || xQueueSend(ctlCmdQueue, &cmd, pdMS_TO_TICKS(50)) != pdTRUE) {
+    loopTaskStat.queueDrops++;
+    return false;
+  }
+  return true;
+}
+
+// [추가] controlTask 가 적용한 명령 수가 target 이 될 때까지 (최대 timeoutMs) 기다림 -> 웹 응답 페이지가 바뀐 모드를 보여 줌
+// [수정] delay(1) 폴링 대신 applyCtlCmd 가 세우는 이벤트 비트를 기다림, 시간 안에 적용되지 않으면 false
+//        (비트는 기다리기 전에 세워져 있을 수 있으므로 깨어날 때마다 수를 다시 확인)
+bool ctlWaitApplied(uint32_t target, uint32_t timeoutMs) {
+  unsigned long start = millis();
+  for (;;) {
+    if ((int32_t)(ctlCmdsApplied.load() - target) >= 0) return true;
+    uint32_t waited = millis() - start;
+    if (waited >= timeoutMs || !ctlAppliedEvents) return false;
+    xEventGroupWaitBits(ctlAppliedEvents, CTL_APPLIED_BIT, pdTRUE, pdFALSE, pdMS_TO_TICKS(timeoutMs - waited));
+  }
+}
+
+uint8_t actuatorBits() {
+  uint8_t act = 0;
+  if (digitalRead(HEATER_PIN) == HIGH)     act |= ACT_HEATER;
+  if (digitalRead(HUMIDIFIER_PWR) == HIGH) act |= ACT_HUMIDIFIER;
+  if (digitalRead(FAN_PIN) == HIGH)        act |= ACT_FAN;
+  return act;
+}
+
+
+
 void humidifierOn() {           // AUTO, ON 상태 구분필요 // humiMode 변수값 수정금지 -> handleSetEnvironment() 여기서 수정함
   if (humidifierMode != OFF) setHumidifierHwOn();
   if (humidifierMode == ON && manualHumidifierStartTime == 0) manualHumidifierStartTime = millis();    // 선택1(함수호출해도 타이머 유지됨)
@@ -1306,7 +2999,7 @@ void humidifierOn() {           // AUTO, ON 상태 구분필요 // humiMode 변
 
 
 void humidifierOff() {
-  if (digitalRead(HUMIDIFIER_PWR) == LOW) return; // Already off
+  if (humiSeq == HS_OFF) return; // Already off
   setHumidifierHwOff();
   manualHumidifierStartTime = 0;
 }
@@ -1383,10 +3076,300 @@ void checkTemperature() {
 
 
 
+// 수동 ON 후 자동 OFF 타이머 처리
+void checkManualAutoOff() {
+  // Check for manual humidifier auto-off
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////
+  if (humidifierMode == ON && manualHumidifierStartTime != 0) {
+    if ((millis() - manualHumidifierStartTime) >= (HUMIDIFIER_AUTO_OFF_MINUTES * 60 * 1000UL)) {
+      humidifierOff();
+      humidifierMode = OFF;                                                 // 상태변경
+      manualHumidifierStartTime = 0;
+      uiPost(UE_MODE_CHANGED);                                              // [수정] 상태저장은 loop 태스크에서
+    }
+  }
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////
+  if (heaterMode == ON &&  manualHeaterStartTime != 0) {
+    if ((millis() - manualHeaterStartTime) >= (HEATER_AUTO_OFF_MINUTES * 60 * 1000UL)) {
+      heaterOff();
+      heaterMode = OFF;                       // 수동 OFF 상태로 변경
+      manualHeaterStartTime = 0;
+      uiPost(UE_MODE_CHANGED);
+   }
+  }
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////
+  if (fanMode == ON && manualFanStartTime != 0) {
+    if ((millis() - manualFanStartTime) >= (FAN_AUTO_OFF_MINUTES * 60 * 1000UL)) {
+      fanOff();
+      fanMode = OFF;                          // 수동 OFF 상태로 변경
+      manualFanStartTime = 0;
+      uiPost(UE_MODE_CHANGED);
+   }
+  }
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////
+}
+
+
+// 센서 1회 측정 결과로 제어 (측정 결과를 받은 CJ_SENSOR_COLLECT 에서 호출)
+void sampleSensorAndControl(bool ok, float temperature, float humidity) {
+  if (ok) {
+      lastTemp = temperature; lastHumi = humidity;
+      accTemp += temperature; accHumi += humidity; accCount++;
+      sensorConsecutiveErrors = 0;
+  } else {
+      lastTemp = NAN; lastHumi = NAN;
+      sensorErrorCount++; sensorConsecutiveErrors++;
+  }
+
+  checkHumidity();
+  checkTemperature();
+  // 온도,습도가 높으면 FAN 가동할 것, checkHumidity() + checkTemperature() => checkEnvironment() 
+
+  // [추가] 그래프 샘플 구간 동안 켜졌던 액추에이터 누적 (제어 결과 반영 후)
+  uint8_t act = actuatorBits();
+  accAct |= act;
+
+  // [수정] 화면 갱신은 loop 태스크에 맡김 (정보창 여부도 거기서 판단)
+  publishState(lastTemp, lastHumi, act);
+  uiPost(UE_SAMPLE);
+}
+
+
+// [추가] 웹에서 바꾼 모드 적용 (AUTO 는 다음 측정에서 판단)
+// [수정] 모드 전역변수는 이 태스크만 씀 (AUTO 포함) -> 바뀌었으면 저장/아이콘 갱신은 UE_MODE_CHANGED 로 loop 태스크에서
+void applyCtlCmd(const CtlCmd &cmd) {
+  bool changed = false;
+  if (cmd.actuator == ACT_HUMIDIFIER) {
+    changed = humidifierMode != cmd.mode;
+    humidifierMode = cmd.mode;
+    if (cmd.mode == ON) humidifierOn(); else if (cmd.mode == OFF) humidifierOff();
+  } else if (cmd.actuator == ACT_HEATER) {
+    changed = heaterMode != cmd.mode;
+    heaterMode = cmd.mode;
+    if (cmd.mode == ON) heaterOn(); else if (cmd.mode == OFF) heaterOff();
+  } else if (cmd.actuator == ACT_FAN) {
+    changed = fanMode != cmd.mode;
+    fanMode = cmd.mode;
+    if (cmd.mode == ON) fanOn(); else if (cmd.mode == OFF) fanOff();
+  }
+  if (changed) uiPost(UE_MODE_CHANGED);
+  ctlCmdsApplied++;
+  xEventGroupSetBits(ctlAppliedEvents, CTL_APPLIED_BIT);
+}
+
+
+
+// 수동 ON 타이머 중 가장 먼저 끝나는 시각으로 CJ_AUTO_OFF 예약 (모드/릴레이가 바뀐 뒤 호출)
+void rearmAutoOff() {
+  struct { OperMode mode; unsigned long start; uint32_t minutes; } t[] = {
+    { humidifierMode, manualHumidifierStartTime, HUMIDIFIER_AUTO_OFF_MINUTES },
+    { heaterMode,     manualHeaterStartTime,     HEATER_AUTO_OFF_MINUTES },
+    { fanMode,        manualFanStartTime,        FAN_AUTO_OFF_MINUTES },
+  };
+  bool any = false;
+  uint32_t due = 0;
+  for (auto &e : t) {
+    if (e.mode != ON || e.start == 0) continue;
+    uint32_t d = e.start + e.minutes * 60 * 1000UL;
+    if (!any || (int32_t)(d - due) < 0) due = d;
+    any = true;
+  }
+  if (any) schedArm(ctlSched, CJ_AUTO_OFF, due);
+  else schedDisarm(ctlSched, CJ_AUTO_OFF);
+}
+
+// [수정] 측정 시작만 하고 결과는 변환 시간 뒤 ctlJobSensorCollect 에서
+void ctlJobSample() {
+  if (sensorMeas.busy) return;                  // 이전 측정이 아직 안 끝남
+  sensorReadCount++;
+  sensorMeas.startUs = micros();
+  sensorMeas.polls = 0;
+  if (!sensorTrigger()) {
+    sampleSensorAndControl(false, NAN, NAN);
+    rearmAutoOff();
+    return;
+  }
+  sensorMeas.busy = true;
+  schedArm(ctlSched, CJ_SENSOR_COLLECT, millis() + sensorConversionMs());
+}
+
+void ctlJobSensorCollect() {
+  float temperature = NAN, humidity = NAN;
+  SensorResult r = sensorCollect(temperature, humidity);
+  SensorLatency &lat = sensorLatency[currentSensorType == 0 ? 0 : 1];
+  if (r == SR_BUSY && ++sensorMeas.polls < SENSOR_MAX_POLLS) {
+    lat.polls++;
+    schedArm(ctlSched, CJ_SENSOR_COLLECT, millis() + SENSOR_POLL_MS);
+    return;
+  }
+  sensorMeas.busy = false;
+
+  if (r == SR_OK) {
+    uint32_t us = micros() - sensorMeas.startUs;
+    lat.lastUs = us;
+    if (us > lat.maxUs) lat.maxUs = us;
+    lat.totalUs += us;
+    lat.count++;
+  }
+  sampleSensorAndControl(r == SR_OK, temperature, humidity);
+  rearmAutoOff();                               // 측정 결과로 ON 이 다시 걸렸을 수 있음
+}
+
+// 그래프 샘플 (구간 평균) -> 플래시 기록과 그래프 갱신은 loop 태스크에서
+void ctlJobGraphSample() {
+  float avgTemp = (accCount > 0) ? (accTemp / accCount) : NAN;
+  float avgHumi = (accCount > 0) ? (accHumi / accCount) : NAN;
+  uiPost(UE_GRAPH_SAMPLE, avgTemp, avgHumi, accAct);
+  accTemp = 0; accHumi = 0; accCount = 0; accAct = 0;
+}
+
+void ctlJobAutoOff() {
+  checkManualAutoOff();
+  rearmAutoOff();
+}
+
+
+// [추가] 센서/제어 태스크: 다음 마감까지 명령을 기다리다가 마감된 작업 실행 -> 스냅샷 발행
+// [수정] millis() 폴링 대신 ctlSched 가 알려준 시간만큼 큐에서 잠듦
+void controlTask(void*) {
+  esp_task_wdt_add(NULL);                       // 태스크별 와치독
+  schedStart(ctlSched, millis(), 0);
+  rearmAutoOff();                               // 부팅 시 ON 으로 복원된 액추에이터
+  for (;;) {
+    CtlCmd cmd;
+    unsigned long waitStartUs = micros();
+    bool gotCmd = xQueueReceive(ctlCmdQueue, &cmd, pdMS_TO_TICKS(ctlSched.idleMs)) == pdTRUE;
+
+    unsigned long cycleStartUs = micros();
+    controlTaskStat.idleUs += cycleStartUs - waitStartUs;
+    if (gotCmd) {
+      applyCtlCmd(cmd);
+      rearmAutoOff();
+    }
+    schedRun(ctlSched, millis());
+
+    // [추가] 측정 사이에 릴레이가 바뀌었으면 (웹 명령, 자동꺼짐) 바로 다시 발행
+    uint8_t act = actuatorBits();
+    if (act != cageStateData.act) publishState(lastTemp, lastHumi, act);
+
+    updateActuatorStats(millis());
+    uint32_t us = micros() - cycleStartUs;
+    if (us > controlTaskStat.maxCycleUs) controlTaskStat.maxCycleUs = us;
+    controlTaskStat.cycles++;
+    esp_task_wdt_reset();
+  }
+}
+
+
+// [추가] 모드 저장 (웹 모드 변경, 수동 ON 자동꺼짐 후 controlTask 가 요청)
+void saveOperModes() {
+  preferences.begin("Storage", false);
+  preferences.putInt("humiMode", static_cast<int>(humidifierMode));
+  preferences.putInt("heatMode", static_cast<int>(heaterMode));
+  preferences.putInt("fanMode",  static_cast<int>(fanMode));
+  preferences.end();
+}
+
+
+// [추가] controlTask 에서 온 이벤트 처리 (loop 태스크)
+void drainUiEvents() {
+  UiEvent ev;
+  while (xQueueReceive(uiEventQueue, &ev, 0) == pdTRUE) {
+    switch (ev.type) {
+      case UE_SAMPLE:
+        // [수정] 정보창이 떠 있지 않을 때만 메인 화면 갱신
+        if (sysInfoDisplayUntil == 0) {
+          uiRequest(UJ_READOUTS);                   // [수정] 그리기는 loop() 끝의 uiSchedule() 에서
+          uiRequest(UJ_FACE);
+          uiRequest(UJ_ICONS);
+        }
+        break;
+      case UE_GRAPH_SAMPLE:
+        pushToDisplayBuffer(ev.temp, ev.humi, ev.act);
+        // [수정] 정보창이 떠 있지 않을 때만 그래프 그리기
+        if (sysInfoDisplayUntil == 0) uiRequest(UJ_GRAPH);
+        break;
+      case UE_MODE_CHANGED:
+        saveOperModes();
+        if (sysInfoDisplayUntil == 0) uiRequest(UJ_ICONS);
+        break;
+    }
+  }
+}
+
+
+void startControlTask() {
+  loopTaskHandle = xTaskGetCurrentTaskHandle();
+  uiEventQueue = xQueueCreate(UI_QUEUE_LEN, sizeof(UiEvent));
+  ctlCmdQueue = xQueueCreate(CTL_QUEUE_LEN, sizeof(CtlCmd));
+  ctlAppliedEvents = xEventGroupCreate();
+  publishState(lastTemp, lastHumi, actuatorBits());
+  xTaskCreatePinnedToCore(controlTask, "control", CONTROL_TASK_STACK, nullptr, CONTROL_TASK_PRIO, &controlTaskHandle, CONTROL_TASK_CORE);
+}
+
+
+// [추가] loop 태스크 스케줄 작업 (바람개비, WiFi 재연결, 통계 출력, 정보창 닫기)
+enum LoopJob { LJ_FAN_ANIM, LJ_WIFI_CHECK, LJ_STATS_PRINT, LJ_SYSINFO_CLOSE, LJ_LONG_PRESS, LJ_CLICK_DONE, NUM_LOOP_JOBS };
+void loopJobFanAnim();
+void loopJobWifiCheck();
+void loopJobStatsPrint();
+void loopJobSysInfoClose();
+void loopJobLongPress();
+void loopJobClickDone();
+SchedJob loopJobs[NUM_LOOP_JOBS] = {
+  { "fan_anim",      loopJobFanAnim,      100,   0, false, 0, 0 },   // 바람개비 부드러운 애니메이션 (0.1초 간격)
+  { "wifi_check",    loopJobWifiCheck,    30000, 0, false, 0, 0 },   // WiFi 자동 재연결 (30초마다 체크)
+  { "stats_print",   loopJobStatsPrint,   60000, 0, false, 0, 0 },   // 1분마다 HTTP 라우트 통계를 시리얼로 출력
+  { "sysinfo_close", loopJobSysInfoClose, 0,     0, false, 0, 0 },   // 정보창 표시 후 3초 (더블 클릭에서 예약)
+  { "long_press",    loopJobLongPress,    0,     0, false, 0, 0 },   // 버튼 누른 뒤 LONG_PRESS_MS (뗄 때 취소)
+  { "click_done",    loopJobClickDone,    0,     0, false, 0, 0 },   // 마지막 클릭 뒤 DOUBLE_CLICK_MS
+};
+Scheduler loopSched = { loopJobs, NUM_LOOP_JOBS, 0 };
+
+void loopJobFanAnim() {
+  // [수정] 정보창이 없고, 팬이 켜져 있을 때만 그리기 (위치/조건은 uiRunJob 에서)
+  if (sysInfoDisplayUntil == 0) uiRequest(UJ_FAN);
+}
+
+void loopJobWifiCheck() {
+  // 와이파이가 끊겨 있고, 설정된 SSID가 있다면
+  if (WiFi.status() != WL_CONNECTED && savedSsid.length() > 0) {
+     Serial.println("WiFi lost. Reconnecting...");
+     WiFi.disconnect(); // 기존 연결 시도 끊기
+     WiFi.begin(savedSsid.c_str(), savedPass.c_str()); // 처음부터 다시 시작
+  }
+}
+
+void loopJobStatsPrint() {
+  printHttpStats();
+  Serial.printf("[task] stack free: control %lu, loop %lu bytes, idle control %lu / loop %lu ms\n",
+                controlTaskHandle ? (unsigned long)uxTaskGetStackHighWaterMark(controlTaskHandle) : 0UL,
+                (unsigned long)uxTaskGetStackHighWaterMark(NULL),
+                (unsigned long)ctlSched.idleMs, (unsigned long)loopSched.idleMs);
+}
+
+// Handle system info display overlay
+void loopJobSysInfoClose() {
+  sysInfoDisplayUntil = 0;
+  tftSync();
+  tft.fillScreen(BG_COLOR);                     // 화면 초기화
+  invalidateWidgets();
+  drawTitle();
+  drawGraphFrame();
+  invalidateGraph();
+  uiRequest(UJ_READOUTS);                       // [수정] 나머지는 여러 loop 에 나눠서 다시 그림
+  uiRequest(UJ_FACE);
+  uiRequest(UJ_ICONS);
+  uiRequest(UJ_GRAPH);
+}
+
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
 void drawSystemInfo() {
+  graphFlushCancel();
   // 1. 배경 지우기 (타이틀바 아래 영역 전체)
   tft.fillRect(0, TITLE_Y + 28, tft.width(), tft.height() - (TITLE_Y + 28), GRID_COLOR);
   
@@ -1436,57 +3419,74 @@ void drawSystemInfo() {
 
 void removeLogFile(){
 
+    histView.active = false;                                      // [추가] 히스토리 화면 종료, 캐시 비움
+    histCacheClear();
     LittleFS.remove(LOG_FILE);
     LittleFS.remove(META_FILE);
     initFlashStorage();
     initDisplayBuffer();
+    invalidateGraph();
     drawGraph();
 }
 
 
 
-void handleEncoderButton() {
-    bool btnCurrState = digitalRead(ENCODER_SW);
-    unsigned long now = millis();
-
-    // Button press detection
-    if (btnPrevState == HIGH && btnCurrState == LOW) {
-        encoderPressStart = now;
+// [수정] 버튼 처리: 디바운스된 눌림/뗌 이벤트로 판정, 길게 누름과 클릭 묶음 종료는 loopSched 작업
+void handleButtonEvent(const InputEvent &ev) {
+    if (ev.type == IE_BTN_DOWN) {
+        encoderPressStart = ev.ms;
         longPressActive = false;
-    }
-    // Button release detection
-    else if (btnPrevState == LOW && btnCurrState == HIGH) {
-        if (!longPressActive) { // It's a click, not the end of a long press
-            unsigned long pressDuration = now - encoderPressStart;
-            if (pressDuration < LONG_PRESS_MS) {
-                btnClickCount++;
-                btnReleaseTime = now;
-            }
-        }
-    }
-    // Long press detection (while holding)
-    else if (btnCurrState == LOW && !longPressActive) {
-        if (now - encoderPressStart > LONG_PRESS_MS) {
-            removeLogFile();
-            longPressActive = true; // Mark that long press action was taken
+        schedArm(loopSched, LJ_LONG_PRESS, ev.ms + LONG_PRESS_MS + 1);
+    } else if (ev.type == IE_BTN_UP) {
+        schedDisarm(loopSched, LJ_LONG_PRESS);
+        if (!longPressActive && ev.ms - encoderPressStart < LONG_PRESS_MS) {   // It's a click, not the end of a long press
+            btnClickCount++;
+            btnReleaseTime = ev.ms;
+            schedArm(loopSched, LJ_CLICK_DONE, ev.ms + DOUBLE_CLICK_MS + 1);
         }
     }
-    
-    // Process clicks after a timeout
-    if (btnClickCount > 0 && now - btnReleaseTime > DOUBLE_CLICK_MS) {
-        if (btnClickCount == 1) {
-            // Single click action
-            changeGraphMode();
-        } else if (btnClickCount == 2) {
-            // Double click action
-            sysInfoDisplayUntil = millis() + 3000;
-            drawSystemInfo();
-        }
-        btnClickCount = 0;
+}
+
+// Long press detection (while holding)
+void loopJobLongPress() {
+    removeLogFile();
+    longPressActive = true; // Mark that long press action was taken
+}
 
+// Process clicks after a timeout
+void loopJobClickDone() {
+    if (btnClickCount == 1) {
+        // Single click action
+        if (histView.active) histZoom();                     // [추가] 히스토리 화면: 확대/축소
+        else changeGraphMode();
+    } else if (btnClickCount == 2) {
+        // Double click action
+        sysInfoDisplayUntil = (millis() + 3000) | 1;        // [수정] 0 이 아니면 정보창 표시 중 (닫기는 loopSched)
+        schedArm(loopSched, LJ_SYSINFO_CLOSE, millis() + 3000);
+        drawSystemInfo();
+    } else if (btnClickCount == 3) {
+        // [추가] Triple click: 히스토리 화면 시작/종료
+        if (histView.active) histExit();
+        else histEnter();
     }
+    btnClickCount = 0;
+}
 
-    btnPrevState = btnCurrState;
+// [추가] 입력 이벤트 큐 비우기 (loop 태스크)
+void handleInputEvents() {
+    int delta = 0;
+    InputEvent ev;
+    while (xQueueReceive(inputQueue, &ev, 0) == pdTRUE) {
+        if (ev.type == IE_ROTATE) delta += ev.delta;
+        else handleButtonEvent(ev);
+    }
+    if (encOverflowDelta != 0) {
+        portENTER_CRITICAL(&encMux);
+        delta += encOverflowDelta;
+        encOverflowDelta = 0;
+        portEXIT_CRITICAL(&encMux);
+    }
+    if (delta != 0) handleEncoderRotation(delta);
 }
 
 
@@ -1511,6 +3511,121 @@ void startAP() {
 
 
 
+// =========================================
+// Runtime Statistics
+// =========================================
+void updateActuatorStats(unsigned long nowMs) {
+  unsigned long dt = nowMs - lastActuatorStatMs;
+  lastActuatorStatMs = nowMs;
+  for (size_t i = 0; i < NUM_ACTUATORS; i++) {
+    if (digitalRead(actuatorStats[i].pin) == HIGH) actuatorStats[i].onMs += dt;
+  }
+}
+
+
+void recordLoopLatency(uint32_t us) {
+  int b = (us == 0) ? 0 : 31 - __builtin_clz(us);
+  if (b >= LOOP_HIST_BUCKETS) b = LOOP_HIST_BUCKETS - 1;
+  loopHist[b]++;
+  if (us > loopMaxUs) loopMaxUs = us;
+
+  unsigned long nowMs = millis();
+  if (nowMs - loopHistStartMs >= LOOP_HIST_WINDOW_MS) {
+    loopHistStartMs = nowMs;
+    memcpy(loopHistPrev, loopHist, sizeof(loopHist));
+    memset(loopHist, 0, sizeof(loopHist));
+    loopMaxUsPrev = loopMaxUs;
+    loopMaxUs = 0;
+  }
+}
+
+
+// 히스토그램에서 q 백분위가 속한 버킷의 상한값(us)
+uint32_t loopLatencyPercentile(float q) {
+  uint32_t total = 0;
+  for (int b = 0; b < LOOP_HIST_BUCKETS; b++) total += loopHistPrev[b];
+  if (total == 0) return 0;
+
+  uint32_t target = (uint32_t)ceilf(total * q);
+  uint32_t acc = 0;
+  for (int b = 0; b < LOOP_HIST_BUCKETS; b++) {
+    acc += loopHistPrev[b];
+    if (acc >= target) return 1UL << (b + 1);
+  }
+  return 1UL << LOOP_HIST_BUCKETS;
+}
+
+
+
+// [추가] HTTP 라우트별 계측 (server.on 대신 onRoute 로 등록)
+// 요청 수, 응답 바이트, 핸들러 처리시간(누적/최대/히스토그램 : 버킷 b = [2^b, 2^(b+1)) ms, 0번은 2ms 미만)
+#define HTTP_HIST_BUCKETS 12                  // 마지막 버킷 = 2초 이상
+struct HttpRouteStat {
+  const char* path;
+  uint32_t requests;
+  uint32_t bytes;
+  uint64_t totalUs;
+  uint32_t maxUs;
+  uint32_t hist[HTTP_HIST_BUCKETS];
+};
+#define MAX_HTTP_ROUTES 24
+HttpRouteStat httpRouteStats[MAX_HTTP_ROUTES];
+int httpRouteCount = 0;
+
+void recordHttpRoute(HttpRouteStat &st, uint32_t us, uint32_t bytes) {
+  uint32_t ms = us / 1000;
+  int b = (ms < 2) ? 0 : 31 - __builtin_clz(ms);
+  if (b >= HTTP_HIST_BUCKETS) b = HTTP_HIST_BUCKETS - 1;
+
+  st.requests++;
+  st.bytes += bytes;
+  st.totalUs += us;
+  if (us > st.maxUs) st.maxUs = us;
+  st.hist[b]++;
+}
+
+WebServer::THandlerFunction instrumentRoute(const char* path, WebServer::THandlerFunction handler) {
+  int id = (httpRouteCount < MAX_HTTP_ROUTES) ? httpRouteCount++ : -1;
+  if (id >= 0) {
+    memset(&httpRouteStats[id], 0, sizeof(HttpRouteStat));
+    httpRouteStats[id].path = path;
+  }
+
+  return [id, handler]() {
+    uint32_t startUs = micros();
+    uint32_t startBytes = server.bytesSent;
+    handler();
+    if (id >= 0) recordHttpRoute(httpRouteStats[id], micros() - startUs, server.bytesSent - startBytes);
+  };
+}
+
+void onRoute(const char* path, HTTPMethod method, WebServer::THandlerFunction handler) {
+  server.on(path, method, instrumentRoute(path, handler));
+}
+
+// 업로드 라우트용 (업로드 콜백 자체는 계측하지 않고 완료 핸들러만 계측)
+void onRoute(const char* path, HTTPMethod method, WebServer::THandlerFunction handler, WebServer::THandlerFunction uploadHandler) {
+  server.on(path, method, instrumentRoute(path, handler), uploadHandler);
+}
+
+
+// 시리얼 모니터로 라우트별 통계 출력 (loop 에서 1분마다)
+void printHttpStats() {
+  Serial.println("[HTTP] path                req      bytes   avg_ms   max_ms");
+  for (int i = 0; i < httpRouteCount; i++) {
+    const HttpRouteStat &st = httpRouteStats[i];
+    if (st.requests == 0) continue;
+    Serial.printf("[HTTP] %-16s %6lu %10lu %8.1f %8.1f\n", st.path,
+                  (unsigned long)st.requests, (unsigned long)st.bytes,
+                  st.totalUs / 1000.0 / st.requests, st.maxUs / 1000.0);
+  }
+}
+
+
+
+
+
+
 // --- Webserver handlers ---
 void handleRoot(bool error = false) {
     server.sendHeader("Connection", "close"); 
@@ -1832,6 +3947,7 @@ const char DASHBOARD_PART2[] PROGMEM = R"rawliteral(
 <a href="/ntpconfig" class="menu-button">Time Sync (NTP)</a>
 <a href="/remote" class="menu-button">Remote Control</a>
 <a href="/sensorconfig" class="menu-button">Device Settings</a>
+<a href="/update" class="menu-button">Firmware Update</a>
 <a href="/downloadlog" class="menu-button download-button">Download Log File</a>
 </div><script>
 const cvs=document.getElementById('myChart');const ctx=cvs.getContext('2d');const msgDiv=document.getElementById('chartMsg');
@@ -1857,9 +3973,104 @@ function setRange(r) {
     drawGraph();
 }
 
+// [추가] 히스토리 캐시: IndexedDB 'cage'/'pts' 에 {t, tp, hm}(10배 정수) 저장, 메모리에는 시간순 배열 T/TP/HM
+// [추가] a: 액추에이터 비트(1 히터, 2 가습기, 4 팬) -> 배열 A (예전에 캐시된 포인트는 0)
+// 장치에는 마지막 캐시 시각 이후(since) 포인트와 비어 있는 과거 구간(before)만 요청함
+const INV = -9999;                      // INVALID_VALUE (데이터 없음)
+const KEEP_SEC = 24 * 3600;             // 캐시 보관 범위 (24H)
+const GAP_SEC = 900;                    // 이 이상 비면 선을 끊음
+let T = [], TP = [], HM = [], A = [];
+let db = null, noOlder = false;
+
+// 서비스워커는 보안 컨텍스트(HTTPS, localhost)에서만 등록 가능
+if('serviceWorker' in navigator && window.isSecureContext) navigator.serviceWorker.register('/sw.js').catch(()=>{});
+
+function openDb(){
+    return new Promise(res=>{
+        if(!window.indexedDB){res(null);return;}
+        const rq = indexedDB.open('cage', 1);
+        rq.onupgradeneeded = ()=>rq.result.createObjectStore('pts', {keyPath:'t'});
+        rq.onsuccess = ()=>res(rq.result);
+        rq.onerror = ()=>res(null);
+    });
+}
+
+function loadDb(){
+    return new Promise(res=>{
+        if(!db){res();return;}
+        const rq = db.transaction('pts').objectStore('pts').getAll();          // 키(t) 오름차순
+        rq.onsuccess = ()=>{ rq.result.forEach(p=>{T.push(p.t);TP.push(p.tp);HM.push(p.hm);A.push(p.a||0);}); res(); };
+        rq.onerror = ()=>res();
+    });
+}
+
+function storeDb(pts){
+    if(!db||!pts.length) return;
+    const os = db.transaction('pts','readwrite').objectStore('pts');
+    pts.forEach(p=>os.put(p));
+}
+
+// 바이너리 포맷 디코딩: int32 base, int32 interval, int16 temp[n], int16 humi[n], uint8 act[n]
+function fetchBin(q){
+    return fetch('/graphdata?fmt=bin&act=1&' + q).then(r=>r.arrayBuffer()).then(buf=>{
+        const n = Math.floor((buf.byteLength - 8) / 5);
+        const out = [];
+        if(n<=0) return out;
+        const hdr = new Int32Array(buf, 0, 2);
+        const tp = new Int16Array(buf, 8, n);
+        const hm = new Int16Array(buf, 8 + n * 2, n);
+        const ac = new Uint8Array(buf, 8 + n * 4, n);
+        for(let i=0; i<n; i++){
+            if(tp[i]===INV && hm[i]===INV) continue;
+            out.push({t:hdr[0] + i * hdr[1], tp:tp[i], hm:hm[i], a:ac[i]});
+        }
+        return out;
+    });
+}
+
+async function refresh(){
+    try {
+        // 1) 마지막 캐시 이후의 새 포인트만 요청 (최초 접속이면 최근 1H를 촘촘하게)
+        const last = T.length ? T[T.length-1] : 0;
+        const nw = await fetchBin('range=' + (last ? 24 : 1) + '&since=' + last);
+        nw.forEach(p=>{T.push(p.t);TP.push(p.tp);HM.push(p.hm);A.push(p.a);});
+        storeDb(nw);
+
+        // 2) 24H 중 비어 있는 과거 구간 보충 (최초 접속 시)
+        if(T.length && !noOlder){
+            const missSec = T[0] - (T[T.length-1] - KEEP_SEC);
+            if(missSec > 3600){
+                const old = await fetchBin('range=' + Math.min(24, Math.ceil(missSec / 3600)) + '&before=' + T[0]);
+                if(!old.length) noOlder = true;
+                T = old.map(p=>p.t).concat(T); TP = old.map(p=>p.tp).concat(TP); HM = old.map(p=>p.hm).concat(HM); A = old.map(p=>p.a).concat(A);
+                storeDb(old);
+            }
+        }
+
+        // 3) 보관 범위를 벗어난 포인트 정리
+        if(T.length){
+            const cut = T[T.length-1] - KEEP_SEC - 3600;
+            let k = 0; while(k < T.length && T[k] < cut) k++;
+            if(k){
+                T.splice(0,k); TP.splice(0,k); HM.splice(0,k); A.splice(0,k);
+                if(db) db.transaction('pts','readwrite').objectStore('pts').delete(IDBKeyRange.upperBound(cut, true));
+            }
+        }
+        drawGraph();
+    } catch(e) {
+        console.log(e); msgDiv.style.display='block'; msgDiv.innerText="Error";
+    }
+}
+
+async function init(){
+    db = await openDb();
+    await loadDb();
+    drawGraph();                        // 캐시된 데이터로 즉시 표시
+    refresh();
+    setInterval(refresh, 60000);
+}
+
 function drawGraph(){
-    fetch('/graphdata?range=' + currentRange)
-    .then(r=>r.json()).then(d=>{
         // [수정] 캔버스 내부 여백 조정: 왼쪽 20, 오른쪽 30 (그래프를 왼쪽으로 당김)
         const w=cvs.clientWidth; const h=150; 
         const padL=20; const padR=30; const bMargin=20;
@@ -1868,31 +4079,38 @@ function drawGraph(){
         const gh = h - bMargin; 
         
         ctx.clearRect(0,0,w,h);
-        if(!d||d.length<2){msgDiv.style.display='block';msgDiv.innerText="Waiting for data...";return;}
-        msgDiv.style.display='none';
-        
-        const lastData = d[d.length-1];
-        if(lastData) {
-            curDiv.innerHTML = `<span style="color:#d9534f">${lastData.tp.toFixed(1)}°C</span> / <span style="color:#0275d8">${lastData.hm.toFixed(1)}%</span>`;
-        }
-        
-        const endTime = lastData.t;
-        const rangeSec = currentRange * 3600; 
-        const startTime = endTime - rangeSec;
 
-        let minT=100, maxT=-50, minH=100, maxH=0;
-        d.forEach(v=>{
-            // 유효 데이터 범위 체크 (-50 ~ 100도, 0 ~ 100%)
-            if(v.tp > -50 && v.tp < 100) {
-                if(v.tp<minT) minT=v.tp; if(v.tp>maxT) maxT=v.tp;
-            }
-            if(v.hm >= 0 && v.hm <= 100) {
-                if(v.hm<minH) minH=v.hm; if(v.hm>maxH) maxH=v.hm;
-            }
-        });
-        
-        if(minT > maxT) { minT=20; maxT=30; } 
-        if(minH > maxH) { minH=40; maxH=60; }
+        const n = T.length;
+        if(n<2){msgDiv.style.display='block';msgDiv.innerText="Waiting for data...";return;}
+        msgDiv.style.display='none';
+
+        const endTime = T[n-1];
+        const rangeSec = currentRange * 3600; 
+        const startTime = endTime - rangeSec;
+
+        // 화면 범위의 첫 인덱스 (이진 탐색)
+        let first = 0, hi = n;
+        while(first < hi){ const m = (first + hi) >> 1; if(T[m] < startTime) first = m + 1; else hi = m; }
+
+        // 마지막 유효값, 최소/최대를 한 번의 루프로 계산 (10배 정수 그대로 비교)
+        let lastIdx=-1;
+        let minT=1000, maxT=-500, minH=1000, maxH=0;
+        for(let i=first; i<n; i++){
+            const t=TP[i], u=HM[i];
+            if(t===INV || u===INV) continue;
+            lastIdx=i;
+            // 유효 데이터 범위 체크 (-50 ~ 100도, 0 ~ 100%)
+            if(t > -500 && t < 1000) { if(t<minT) minT=t; if(t>maxT) maxT=t; }
+            if(u >= 0 && u <= 1000)  { if(u<minH) minH=u; if(u>maxH) maxH=u; }
+        }
+
+        if(lastIdx >= 0) {
+            curDiv.innerHTML = `<span style="color:#d9534f">${(TP[lastIdx]/10).toFixed(1)}°C</span> / <span style="color:#0275d8">${(HM[lastIdx]/10).toFixed(1)}%</span>`;
+        }
+
+        if(minT > maxT) { minT=200; maxT=300; } 
+        if(minH > maxH) { minH=400; maxH=600; }
+        minT/=10; maxT/=10; minH/=10; maxH/=10;
 
         minT=Math.floor(minT-1); maxT=Math.ceil(maxT+1);
         minH=Math.floor(minH-2); maxH=Math.ceil(maxH+2);
@@ -1958,40 +4176,81 @@ function drawGraph(){
 
 
 const char DASHBOARD_PART3[] PROGMEM = R"rawliteral(
-function drawLine(key, color, minVal, rangeVal){
+function drawLine(arr, color, minVal, rangeVal){
     ctx.beginPath();
     ctx.strokeStyle = color;
     ctx.lineWidth = 2;
     ctx.lineJoin = 'round';
     
-    let firstPoint = true;
+    let lastT = 0;
+
+    for(let i=first; i<n; i++){
+        const v = arr[i];
+        if(v === INV) continue;
 
-    d.forEach((v)=>{
         // [핵심] 시간 기반 좌표 계산 (LCD 스타일)
-        let x = padL + ((v.t - startTime) / rangeSec) * gw;
+        let x = padL + ((T[i] - startTime) / rangeSec) * gw;
+        let y = gh - ((v / 10 - minVal) / rangeVal * gh);
         
-        // 그래프 범위(왼쪽 여백)보다 오른쪽에 있는 데이터만 그리기
-        if(x >= padL - 5) { 
-            let val = v[key];
-            let y = gh - ((val - minVal) / rangeVal * gh);
-            
-            if(firstPoint) { ctx.moveTo(x,y); firstPoint = false; }
-            else ctx.lineTo(x,y);
-        }
-    });
+        // 데이터가 GAP_SEC 이상 비면 선을 끊음
+        if(T[i] - lastT > GAP_SEC) ctx.moveTo(x,y);
+        else ctx.lineTo(x,y);
+        lastT = T[i];
+    }
     ctx.stroke();
 }
 
-drawLine('tp', '#d9534f', minT, rngT);
-drawLine('hm', '#0275d8', minH, rngH);
+// [추가] 액추에이터 띠: 그래프 바닥에 히터/가습기/팬 순으로, 포인트부터 다음 포인트까지 반투명 칠함
+const BAND_H = 4;
+const BANDS = [['rgba(217,83,79,0.35)', 1], ['rgba(91,192,222,0.35)', 2], ['rgba(92,184,92,0.35)', 4]];
+BANDS.forEach(([color, bit], b)=>{
+    ctx.fillStyle = color;
+    const y = gh - (b + 1) * BAND_H;
+    for(let i=first; i<n; i++){
+        if(!(A[i] & bit)) continue;
+        const t1 = (i + 1 < n && T[i+1] - T[i] <= GAP_SEC) ? T[i+1] : T[i] + 12;
+        const x0 = padL + ((T[i] - startTime) / rangeSec) * gw;
+        const x1 = padL + ((t1 - startTime) / rangeSec) * gw;
+        ctx.fillRect(x0, y, Math.max(1, x1 - x0), BAND_H);
+    }
+});
+
+drawLine(TP, '#d9534f', minT, rngT);
+drawLine(HM, '#0275d8', minH, rngH);
 
-}).catch(e=>{console.log(e);msgDiv.style.display='block';msgDiv.innerText="Error";});}
-setTimeout(drawGraph,2000);setInterval(drawGraph,60000);
+}
+init();
 </script></body></html>)rawliteral";
 
 
 
 
+// [추가] 대시보드 서비스워커: /dashboard 페이지를 캐시에서 바로 제공 (펌웨어 빌드마다 캐시 이름이 바뀌어 자동 갱신)
+const char SERVICE_WORKER_JS[] PROGMEM = "const CACHE='cage-" __DATE__ " " __TIME__ "';" R"rawliteral(
+self.addEventListener('install', e => {
+    e.waitUntil(caches.open(CACHE).then(c => c.add('/dashboard')));
+    self.skipWaiting();
+});
+self.addEventListener('activate', e => {
+    e.waitUntil(caches.keys().then(ks => Promise.all(ks.filter(k => k !== CACHE).map(k => caches.delete(k)))));
+    self.clients.claim();
+});
+self.addEventListener('fetch', e => {
+    const u = new URL(e.request.url);
+    if (e.request.method !== 'GET' || u.pathname !== '/dashboard') return;     // 데이터 요청은 항상 장치로
+    e.respondWith(caches.match('/dashboard').then(r => r || fetch(e.request)));
+});
+)rawliteral";
+
+
+void handleServiceWorker() {
+    server.sendHeader("Connection", "close");
+    server.sendHeader("Cache-Control", "no-cache");
+    server.send_P(200, "application/javascript", SERVICE_WORKER_JS);
+}
+
+
+
 void handleDashboard() {
     server.sendHeader("Connection", "close");
     server.setContentLength(CONTENT_LENGTH_UNKNOWN);
@@ -2061,8 +4320,9 @@ void handleRemote() {
     char buffer[1024]; 
     char tempStr[10]; char humiStr[10];
 
-    if (isnan(lastTemp)) strcpy(tempStr, "N/A"); else snprintf(tempStr, sizeof(tempStr), "%.1f", lastTemp);
-    if (isnan(lastHumi)) strcpy(humiStr, "N/A"); else snprintf(humiStr, sizeof(humiStr), "%.1f", lastHumi);
+    const CageState st = readState();
+    if (isnan(st.temp)) strcpy(tempStr, "N/A"); else snprintf(tempStr, sizeof(tempStr), "%.1f", st.temp);
+    if (isnan(st.humi)) strcpy(humiStr, "N/A"); else snprintf(humiStr, sizeof(humiStr), "%.1f", st.humi);
 
     // 현재 상태 표시
     snprintf(buffer, sizeof(buffer), "<div style='text-align:center; padding:10px; background:#e9ecef; border-radius:5px; margin-bottom:15px;'>"
@@ -2149,17 +4409,18 @@ void handleSensorData() {
   char json_buffer[100];
   char temp_str[10];
   char humi_str[10];
+  const CageState st = readState();
 
-  if (isnan(lastTemp)) {
+  if (isnan(st.temp)) {
     strcpy(temp_str, "N/A");
   } else {
-    snprintf(temp_str, sizeof(temp_str), "%.1f", lastTemp);
+    snprintf(temp_str, sizeof(temp_str), "%.1f", st.temp);
   }
 
-  if (isnan(lastHumi)) {
+  if (isnan(st.humi)) {
     strcpy(humi_str, "N/A");
   } else {
-    snprintf(humi_str, sizeof(humi_str), "%.1f", lastHumi);
+    snprintf(humi_str, sizeof(humi_str), "%.1f", st.humi);
   }
 
   snprintf(json_buffer, sizeof(json_buffer), "{\"temp\":\"%s\",\"humi\":\"%s\"}", temp_str, humi_str);
@@ -2169,6 +4430,13 @@ void handleSensorData() {
 
 
 
+// 웹 폼 값 ("on" / "off" / 그 외 AUTO) -> OperMode
+OperMode parseOperMode(const String &v) {
+    if (v == "on") return ON;
+    if (v == "off") return OFF;
+    return AUTO;
+}
+
 void handleSetTerminal() {
     bool valuesChanged = false;
 
@@ -2213,72 +4481,17 @@ void handleSetTerminal() {
 
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    if (server.hasArg("humi_mode")) {
-        String humiMode = server.arg("humi_mode");      // humi (지역변수), humidifierMode (전역변수, OperMode 타입)
-        OperMode oldHumidifierMode = humidifierMode;
-
-        if (humiMode == "on") {
-            humidifierMode = ON;
-            humidifierOn();                 // This sets humidifierMode to ON
-        } else if (humiMode == "off") {
-            humidifierMode = OFF;
-            humidifierOff();
-        } else {
-            humidifierMode = AUTO;
-            //humidifierOff();
-        }
-
-        if (oldHumidifierMode != humidifierMode) {                               // If humiMode changed, save it to Preferences
-            preferences.begin("Storage", false);                                 // 저장소를 공통으로 사용함(온도,습도,가습기,히터,팬) (-> Terminal)
-            preferences.putInt("humiMode", static_cast<int>(humidifierMode));
-            preferences.end();
-        }
-    }
-
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    if (server.hasArg("heat_mode")) {
-      String heatMode = server.arg("heat_mode");          // heatMode 지역변수, heaterMode 전역변수
-      OperMode oldHeaterMode = heaterMode;
-
-        if (heatMode == "on") {
-            heaterMode = ON;
-            heaterOn();                 // This sets heaterMode to ON
-        } else if (heatMode == "off") {
-            heaterMode = OFF;
-            heaterOff();
-        } else {
-            heaterMode = AUTO;
-            //heaterOff();
-        }
-
-      if (oldHeaterMode != heaterMode) {                                 // If humiMode changed, save it to Preferences
-          preferences.begin("Storage", false);                           // 저장소를 공통으로 사용함 (-> Terminal)
-          preferences.putInt("heatMode", static_cast<int>(heaterMode));
-          preferences.end();
-      }
-    }
-
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    if (server.hasArg("fan_mode")) {
-        String _fanMode = server.arg("fan_mode");          // _fanMode 지역변수, fanMode 전역변수
-        OperMode oldFanMode = fanMode;
-
-        if (_fanMode == "on") {
-            fanMode = ON;
-            fanOn();
-        } else if (_fanMode == "off") {
-            fanMode = OFF;
-            fanOff();
-        } else {
-            fanMode = AUTO;
-            //fanOff(); 
-        }
-
-        if (oldFanMode != fanMode) {                                       // If humiMode changed, save it to Preferences
-            preferences.begin("Storage", false);                           // 저장소를 공통으로 사용함 (-> Terminal)
-            preferences.putInt("fanMode", static_cast<int>(fanMode));
-            preferences.end();
-        }
+    // [수정] 모드 전역변수는 controlTask 만 씀: AUTO 포함 모든 모드 변경을 ctlPost 로 보내고
+    //        저장(Preferences)과 아이콘 갱신은 controlTask 가 보내는 UE_MODE_CHANGED 에서 (drainUiEvents)
+    // [수정] 큐가 가득 찼거나 제시간에 적용되지 않으면 바뀌지 않은 페이지를 성공처럼 보여 주지 않고 503
+    uint32_t appliedTarget = ctlCmdsApplied.load();
+    bool queued = true;
+    if (server.hasArg("humi_mode")) { queued &= ctlPost(ACT_HUMIDIFIER, parseOperMode(server.arg("humi_mode"))); appliedTarget++; }
+    if (server.hasArg("heat_mode")) { queued &= ctlPost(ACT_HEATER, parseOperMode(server.arg("heat_mode")));     appliedTarget++; }
+    if (server.hasArg("fan_mode"))  { queued &= ctlPost(ACT_FAN, parseOperMode(server.arg("fan_mode")));         appliedTarget++; }
+    if (!queued || !ctlWaitApplied(appliedTarget, CTL_APPLY_TIMEOUT_MS)) {
+        server.send(503, "text/plain", queued ? "Control task did not apply the change in time." : "Control queue full.");
+        return;
     }
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -2648,18 +4861,7 @@ void handleSensorSave() {
         String infoText = "Nothing changed.";
 
         if (rotationChanged) {
-            updateLayout(); 
-            tft.setRotation(screenRotation); 
-            tft.fillScreen(BG_COLOR); 
-            graphSprite.deleteSprite();
-            graphSprite.setColorDepth(16);
-            graphSprite.createSprite(layout_graph_w, layout_graph_h);
-            drawTitle();
-            updateGraphTimeScale();
-            drawGraphFrame();
-            drawGraph();
-            drawConditionFace();
-            drawStatusIcons();
+            applyScreenRotation();
             
             infoText = "Rotation applied immediately.";
         }
@@ -2719,7 +4921,8 @@ void handleDownloadLog() {
         logFile.seek(current_flash_index * sizeof(LogRecord));
         
         if (logFile.read((uint8_t*)&rec, sizeof(LogRecord)) == sizeof(LogRecord)) {
-            if (rec.ts == 0 || rec.temp == INVALID_VALUE || rec.humi == INVALID_VALUE) {
+            int16_t humi = recHumi(rec);
+            if (rec.ts == 0 || rec.temp == INVALID_VALUE || humi == INVALID_VALUE) {
                 continue;
             }
             struct tm *timeinfo; time_t rawtime = rec.ts; timeinfo = localtime(&rawtime);
@@ -2731,7 +4934,7 @@ void handleDownloadLog() {
             snprintf(line_buffer, sizeof(line_buffer), "%s,%.1f,%.1f,%lu\n",
                      timeStr,
                      rec.temp / 10.0f,
-                     rec.humi / 10.0f,
+                     humi / 10.0f,
                      (unsigned long)rec.ts);
             server.sendContent(line_buffer, strlen(line_buffer));
             yield();                                              // Allow system tasks to run, preventing watchdog timeout
@@ -2765,6 +4968,103 @@ void ntpUpdate() {
 
 
 
+// [추가] 바이너리 그래프 데이터 (/graphdata?fmt=bin)
+// 형식(little-endian): int32 baseTs, int32 interval, int16 temp[n], int16 humi[n]
+//   i번째 포인트 시각 = baseTs + i * interval, 값은 10배 정수 (INVALID_VALUE = 해당 구간 데이터 없음)
+//   [수정] interval 이 기록 간격보다 길면 구간 (baseTs + (i-1)*interval, baseTs + i*interval] 의 레코드 평균
+//          (temp/humi 모두 같은 구간 평균, 센서 오류 레코드는 그 값만 빠짐) -> 짧은 스파이크는 평균에 묻힘
+//   n = (전체 길이 - 8) / 4
+// 옵션: since=<epoch> 이후 레코드만 (브라우저 캐시 증분), before=<epoch> 이전 레코드만 (과거 구간 보충)
+// [추가] act=1 이면 뒤에 uint8 act[n] (구간 동안 켜졌던 액추에이터, ACT_* OR) 추가 -> n = (전체 길이 - 8) / 5
+#define GRAPH_BIN_MAX_POINTS 300
+
+int16_t graphBinTemp[GRAPH_BIN_MAX_POINTS];
+int16_t graphBinHumi[GRAPH_BIN_MAX_POINTS];
+uint8_t graphBinAct[GRAPH_BIN_MAX_POINTS];
+
+// [추가] 한 슬롯의 누적 (slot < 0 이면 비어 있음)
+struct GraphBinSum {
+    int slot;
+    int32_t temp, humi;
+    uint16_t tempN, humiN;
+};
+
+// 반올림 평균 (음수 온도 포함)
+int16_t graphBinMean(int32_t sum, uint16_t n) {
+    return (int16_t)(sum >= 0 ? (sum + n / 2) / n : -((-sum + n / 2) / n));
+}
+
+void graphBinFlush(const GraphBinSum &sum) {
+    if (sum.slot < 0) return;
+    if (sum.tempN) graphBinTemp[sum.slot] = graphBinMean(sum.temp, sum.tempN);
+    if (sum.humiN) graphBinHumi[sum.slot] = graphBinMean(sum.humi, sum.humiN);
+}
+
+void handleGraphDataBin(int hours, uint32_t since, uint32_t before, bool withAct) {
+    if (hours > DISPLAY_MAX_HOURS) hours = DISPLAY_MAX_HOURS;
+
+    int total_available = isDisplayBufferFull ? DISPLAY_MAX_SAMPLES : displayLogIndex;
+    uint32_t endTs = 0;
+    if (total_available > 0) {
+        endTs = displayLogBuf[(displayLogIndex - 1 + DISPLAY_MAX_SAMPLES) % DISPLAY_MAX_SAMPLES].ts;
+    }
+    if (before > 0 && endTs >= before) endTs = before - 1;
+
+    // since 가 주어지면 그 이후 구간만 (새 데이터가 없으면 빈 응답)
+    uint32_t rangeSec = hours * 3600UL;
+    if (since > 0) {
+        if (endTs <= since) endTs = 0;
+        else if (endTs - since < rangeSec) rangeSec = endTs - since;
+    }
+
+    uint32_t interval = (rangeSec + GRAPH_BIN_MAX_POINTS - 1) / GRAPH_BIN_MAX_POINTS;
+    if (interval < GRAPH_SAMPLE_INTERVAL_SEC) interval = GRAPH_SAMPLE_INTERVAL_SEC;
+    int count = (endTs != 0) ? (int)((rangeSec + interval - 1) / interval) : 0;
+
+    for (int i = 0; i < count; i++) {
+        graphBinTemp[i] = INVALID_VALUE;
+        graphBinHumi[i] = INVALID_VALUE;
+        graphBinAct[i] = 0;
+    }
+
+    // 최신 레코드부터 거꾸로 훑으면서 interval 구간(슬롯)에 배치
+    // 슬롯 i 는 (startTs + i*interval, startTs + (i+1)*interval] 구간
+    // [수정] 구간의 가장 최근 값 하나만 쓰면 나머지 레코드를 버리고 temp/humi 가 서로 다른 레코드에서 올 수 있음
+    //        -> 슬롯마다 유효한 값의 평균 (레코드가 시간순이므로 슬롯이 바뀔 때 앞 슬롯을 확정, 슬롯별 누적 배열 없음)
+    uint32_t startTs = endTs - count * interval;
+    GraphBinSum sum = { -1, 0, 0, 0, 0 };
+    for (int i = 0; i < total_available && count > 0; i++) {
+        const LogRecord &rec = displayLogBuf[(displayLogIndex - 1 - i + 2 * DISPLAY_MAX_SAMPLES) % DISPLAY_MAX_SAMPLES];
+        if (rec.ts == 0 || rec.ts == 0xFFFFFFFF || rec.ts > endTs) continue;
+        if (rec.ts <= startTs || rec.ts <= since) break;
+
+        int slot = (rec.ts - startTs - 1) / interval;
+        if (slot != sum.slot) {
+            graphBinFlush(sum);
+            sum = { slot, 0, 0, 0, 0 };
+        }
+        int16_t humi = recHumi(rec);
+        if (rec.temp != INVALID_VALUE) { sum.temp += rec.temp; sum.tempN++; }
+        if (humi != INVALID_VALUE)     { sum.humi += humi;     sum.humiN++; }
+        graphBinAct[slot] |= recActuators(rec);
+    }
+    graphBinFlush(sum);
+
+    int32_t header[2] = { (int32_t)(startTs + interval), (int32_t)interval };
+
+    server.sendHeader("Connection", "close");
+    server.setContentLength(sizeof(header) + count * (2 * sizeof(int16_t) + (withAct ? 1 : 0)));
+    server.send(200, "application/octet-stream", "");
+    server.sendContent((const char*)header, sizeof(header));
+    if (count > 0) {
+        server.sendContent((const char*)graphBinTemp, count * sizeof(int16_t));
+        server.sendContent((const char*)graphBinHumi, count * sizeof(int16_t));
+        if (withAct) server.sendContent((const char*)graphBinAct, count);
+    }
+}
+
+
+
 void handleGraphData() {
     esp_task_wdt_reset();
 
@@ -2774,6 +5074,13 @@ void handleGraphData() {
         if (hours < 1) hours = 1;
     }
 
+    if (server.arg("fmt") == "bin") {
+        uint32_t since  = server.hasArg("since")  ? strtoul(server.arg("since").c_str(), NULL, 10)  : 0;
+        uint32_t before = server.hasArg("before") ? strtoul(server.arg("before").c_str(), NULL, 10) : 0;
+        handleGraphDataBin(hours, since, before, server.arg("act") == "1");
+        return;
+    }
+
     server.sendHeader("Connection", "close");
     server.setContentLength(CONTENT_LENGTH_UNKNOWN);
     server.send(200, "application/json", "[");
@@ -2808,20 +5115,22 @@ void handleGraphData() {
         int idx = (startIdx + offset) % DISPLAY_MAX_SAMPLES;
         
         // [핵심 수정] 타임스탬프가 0이거나, 온도/습도가 에러값(INVALID_VALUE)이면 건너뜀
+        int16_t humi = recHumi(displayLogBuf[idx]);
         if (displayLogBuf[idx].ts == 0 || 
             displayLogBuf[idx].temp == INVALID_VALUE || 
-            displayLogBuf[idx].humi == INVALID_VALUE) {
+            humi == INVALID_VALUE) {
             continue;
         }
 
-        int len = snprintf(temp, sizeof(temp), "%s{\"t\":%lu,\"tp\":%.1f,\"hm\":%.1f}", 
+        int len = snprintf(temp, sizeof(temp), "%s{\"t\":%lu,\"tp\":%.1f,\"hm\":%.1f,\"a\":%u}", 
                 first ? "" : ",", 
                 (unsigned long)displayLogBuf[idx].ts, 
                 displayLogBuf[idx].temp / 10.0f, 
-                displayLogBuf[idx].humi / 10.0f);
+                humi / 10.0f,
+                (unsigned)recActuators(displayLogBuf[idx]));
         first = false;
 
-        if (chunkPos + len >= sizeof(chunk) - 1) {
+        if ((size_t)(chunkPos + len) >= sizeof(chunk) - 1) {
             server.sendContent(chunk);
             chunkPos = 0;
             chunk[0] = '\0';
@@ -2840,8 +5149,510 @@ void handleGraphData() {
 
 
 
+// =========================================
+// OTA Firmware Update
+// =========================================
+// [추가] 업로드되는 이미지를 받는 즉시 비활성 OTA 파티션에 기록 (전체 버퍼링 없음)
+//  - 인증: 로그인 ID/PW 로 HTTP Basic 인증
+//  - 검증: ?md5=<32자리 hex> 필수 (없으면 Update.begin 전에 거부), 이미지 헤더/체크섬과 MD5 는 Update.end() 에서 검증
+//  - 업로드 중에도 센서 측정/릴레이 제어는 controlTask 에서 계속 수행
+//  예) curl -u Cage:cage1234 -F "firmware=@firmware.bin" "http://192.168.2.1/update?md5=$(md5sum firmware.bin | cut -c1-32)"
+bool otaAuthorized = false;
+bool otaInProgress = false;
+size_t otaWritten = 0;
+char otaError[64] = "";
+
+void setOtaError(const char* msg) {
+  if (otaError[0] == '\0') strncpy(otaError, msg, sizeof(otaError) - 1);
+}
+
+// [추가] 32자리 hex 인지 (Update.setMD5 는 길이만 봄)
+bool otaMd5Valid(const String &md5) {
+  if (md5.length() != 32) return false;
+  for (size_t i = 0; i < 32; i++) if (!isxdigit((unsigned char)md5[i])) return false;
+  return true;
+}
+
+
+// 업로드 청크 사이에 loop 태스크 와치독 리셋 (handleClient 가 업로드 끝날 때까지 반환하지 않음)
+// [수정] 센서 측정/릴레이 제어는 controlTask 에서 계속 돌아가므로 여기서는 하지 않음
+void serviceControlDuringOta() {
+  esp_task_wdt_reset();
+}
+
+
+void handleOtaPage() {
+  if (!server.authenticate(loginUser.c_str(), loginPass.c_str())) return server.requestAuthentication();
+
+  server.sendHeader("Connection", "close");
+  server.send(200, "text/html; charset=UTF-8", F("<!DOCTYPE html><html><head><title>Firmware Update</title><meta charset=\"UTF-8\"><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\"><style>"
+      "body{font-family:sans-serif;background-color:#f4f4f4;margin:0;padding:10px;color:#333}"
+      ".container{max-width:500px;margin:0 auto;background-color:#fff;padding:15px;border-radius:8px;box-shadow:0 2px 5px rgba(0,0,0,.1)}"
+      "h2{text-align:center;color:#007bff;margin:0 0 15px 0;font-size:1.4em}"
+      "input{width:100%;padding:8px;margin-bottom:10px;box-sizing:border-box}"
+      "input[type='submit'], .btn-back{width:100%;padding:10px;border:none;border-radius:4px;font-size:1em;font-weight:bold;cursor:pointer;display:block;text-align:center;text-decoration:none;box-sizing:border-box}"
+      "input[type='submit']{background-color:#28a745;color:#fff}"
+      ".btn-back{background-color:#6c757d;color:#fff;margin-top:10px}"
+      "</style></head><body><div class=\"container\"><h2>Firmware Update</h2>"
+      "<form method='POST' action='/update' enctype='multipart/form-data' onsubmit=\"this.action='/update?md5='+document.getElementById('md5').value.trim();\">"
+      "<input type='file' name='firmware' accept='.bin' required>"
+      "<input id='md5' type='text' placeholder='MD5 (md5sum firmware.bin)' pattern='[0-9a-fA-F]{32}' required>"
+      "<input type='submit' value='Upload & Reboot'></form>"
+      "<a href='/dashboard' class='btn-back'>Back to Dashboard</a></div></body></html>"));
+}
+
+
+void handleOtaUpload() {
+  HTTPUpload& upload = server.upload();
+
+  if (upload.status == UPLOAD_FILE_START) {
+    otaError[0] = '\0';
+    otaWritten = 0;
+    otaAuthorized = server.authenticate(loginUser.c_str(), loginPass.c_str());
+    if (!otaAuthorized) return;
+
+    // [수정] MD5 없이는 받지 않음: 이미지 체크섬만으로는 다른 빌드나 중간에 잘린 이미지를 못 거름
+    String md5 = server.arg("md5");
+    if (!otaMd5Valid(md5)) { setOtaError("MD5 required: /update?md5=<32 hex>"); return; }
+    if (!Update.begin(UPDATE_SIZE_UNKNOWN, U_FLASH)) { setOtaError(Update.errorString()); return; }
+    if (!Update.setMD5(md5.c_str())) { setOtaError("Invalid MD5"); Update.abort(); return; }
+    otaInProgress = true;
+    Serial.printf("[OTA] start: %s\n", upload.filename.c_str());
+  }
+  else if (upload.status == UPLOAD_FILE_WRITE) {
+    if (otaInProgress && otaError[0] == '\0') {
+      if (Update.write(upload.buf, upload.currentSize) != upload.currentSize) {
+        setOtaError(Update.errorString());
+        Update.abort();
+        otaInProgress = false;
+      } else {
+        otaWritten += upload.currentSize;
+      }
+    }
+    serviceControlDuringOta();
+  }
+  else if (upload.status == UPLOAD_FILE_END) {
+    if (otaInProgress && otaError[0] == '\0') {
+      // MD5/이미지 검증 후 다음 부팅 파티션으로 지정
+      if (!Update.end(true)) setOtaError(Update.errorString());
+    }
+    otaInProgress = false;
+    Serial.printf("[OTA] end: %u bytes, %s\n", (unsigned)otaWritten, otaError[0] ? otaError : "OK");
+  }
+  else if (upload.status == UPLOAD_FILE_ABORTED) {
+    if (otaInProgress) Update.abort();
+    setOtaError("Upload aborted");
+    otaInProgress = false;
+  }
+}
+
+
+void handleOtaFinish() {
+  if (!otaAuthorized) return server.requestAuthentication();
+
+  server.sendHeader("Connection", "close");
+  if (otaError[0] != '\0' || otaWritten == 0) {
+    setOtaError("No firmware received");
+    server.send(500, "text/plain", otaError);
+    return;
+  }
+
+  server.send_P(200, "text/html; charset=UTF-8", SAVE_SUCCESS_PAGE);
+  delay(1000);
+  ESP.restart();
+}
+
+
+
+
+
+
+// [추가] Prometheus 텍스트 포맷 출력기
+// 고정 크기 버퍼에 snprintf 로 채우고 가득 차면 sendContent 로 흘려보냄 (String/힙 할당 없음)
+// [수정] 버퍼보다 긴 줄은 예전에는 조용히 버려졌음 -> 그 줄만 힙에 만들어 바로 보내고, 그것도 못 하면 metricsTruncated 에 셈
+uint32_t metricsTruncated = 0;                               // cage_metrics_truncated_total
+
+struct MetricsWriter {
+  char buf[512];
+  size_t len = 0;
+
+  void flush() {
+    if (len > 0) { server.sendContent(buf, len); len = 0; }
+  }
+
+  void printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + len, sizeof(buf) - len, fmt, args);
+    va_end(args);
+    if (n < 0) { metricsTruncated++; return; }
+    if (len + n < sizeof(buf)) { len += n; return; }
+
+    flush();                                                 // 공간 부족 -> 비우고 한 번 더
+    va_start(args, fmt);
+    if ((size_t)n < sizeof(buf)) {
+      len = vsnprintf(buf, sizeof(buf), fmt, args);
+    } else if (char* line = (char*)malloc(n + 1)) {
+      vsnprintf(line, n + 1, fmt, args);
+      server.sendContent(line, n);
+      free(line);
+    } else {
+      metricsTruncated++;
+    }
+    va_end(args);
+  }
+};
+
+static const char* operModeName(OperMode m) {
+  return (m == AUTO) ? "auto" : (m == ON) ? "on" : "off";
+}
+
+void handleMetrics() {
+  server.sendHeader("Connection", "close");
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/plain; version=0.0.4", "");
+
+  MetricsWriter w;
+
+  // --- 온습도 및 설정값 ---
+  const CageState st = readState();
+  w.printf("# TYPE cage_temperature_celsius gauge\ncage_temperature_celsius %.2f\n", st.temp);
+  w.printf("# TYPE cage_humidity_percent gauge\ncage_humidity_percent %.2f\n", st.humi);
+  w.printf("# TYPE cage_temperature_threshold_celsius gauge\n"
+           "cage_temperature_threshold_celsius{bound=\"min\"} %d\n"
+           "cage_temperature_threshold_celsius{bound=\"max\"} %d\n", tempMin, tempMax);
+  w.printf("# TYPE cage_humidity_threshold_percent gauge\n"
+           "cage_humidity_threshold_percent{bound=\"min\"} %d\n"
+           "cage_humidity_threshold_percent{bound=\"max\"} %d\n", humiMin, humiMax);
+
+  // --- 액추에이터 상태 / 누적 동작시간 / 운전모드 ---
+  const OperMode modes[NUM_ACTUATORS] = { humidifierMode, heaterMode, fanMode };
+  w.printf("# TYPE cage_actuator_on gauge\n");
+  for (size_t i = 0; i < NUM_ACTUATORS; i++) {
+    w.printf("cage_actuator_on{actuator=\"%s\"} %d\n", actuatorStats[i].name, (st.act & actuatorStats[i].act) ? 1 : 0);
+  }
+  w.printf("# TYPE cage_actuator_on_seconds_total counter\n");
+  for (size_t i = 0; i < NUM_ACTUATORS; i++) {
+    w.printf("cage_actuator_on_seconds_total{actuator=\"%s\"} %.1f\n", actuatorStats[i].name, actuatorStats[i].onMs / 1000.0);
+  }
+  w.printf("# TYPE cage_actuator_mode gauge\n");
+  for (size_t i = 0; i < NUM_ACTUATORS; i++) {
+    for (int m = AUTO; m <= OFF; m++) {
+      w.printf("cage_actuator_mode{actuator=\"%s\",mode=\"%s\"} %d\n",
+               actuatorStats[i].name, operModeName((OperMode)m), modes[i] == m ? 1 : 0);
+    }
+  }
+
+  // --- 센서 ---
+  const char* sensorName = (currentSensorType == 0) ? "sht41" : "aht20";
+  w.printf("# TYPE cage_sensor_reads_total counter\ncage_sensor_reads_total{sensor=\"%s\"} %lu\n", sensorName, (unsigned long)sensorReadCount);
+  w.printf("# TYPE cage_sensor_errors_total counter\ncage_sensor_errors_total{sensor=\"%s\"} %lu\n", sensorName, (unsigned long)sensorErrorCount);
+  w.printf("# TYPE cage_sensor_consecutive_errors gauge\ncage_sensor_consecutive_errors %lu\n", (unsigned long)sensorConsecutiveErrors);
+  w.printf("# TYPE cage_sensor_latency_us gauge\n");
+  for (const SensorLatency &lat : sensorLatency) {
+    if (lat.count == 0) continue;
+    w.printf("cage_sensor_latency_us{sensor=\"%s\",stat=\"last\"} %lu\n", lat.name, (unsigned long)lat.lastUs);
+    w.printf("cage_sensor_latency_us{sensor=\"%s\",stat=\"max\"} %lu\n", lat.name, (unsigned long)lat.maxUs);
+    w.printf("cage_sensor_latency_us{sensor=\"%s\",stat=\"avg\"} %lu\n", lat.name, (unsigned long)(lat.totalUs / lat.count));
+  }
+  w.printf("# TYPE cage_sensor_busy_polls_total counter\n");
+  for (const SensorLatency &lat : sensorLatency) w.printf("cage_sensor_busy_polls_total{sensor=\"%s\"} %lu\n", lat.name, (unsigned long)lat.polls);
+
+  // --- 시스템 ---
+  w.printf("# TYPE cage_uptime_seconds counter\ncage_uptime_seconds %lu\n", millis() / 1000);
+  w.printf("# TYPE cage_heap_free_bytes gauge\ncage_heap_free_bytes %lu\n", (unsigned long)ESP.getFreeHeap());
+  w.printf("# TYPE cage_heap_min_free_bytes gauge\ncage_heap_min_free_bytes %lu\n", (unsigned long)ESP.getMinFreeHeap());
+  w.printf("# TYPE cage_loop_latency_us summary\n"
+           "cage_loop_latency_us{quantile=\"0.5\"} %lu\n"
+           "cage_loop_latency_us{quantile=\"0.9\"} %lu\n"
+           "cage_loop_latency_us{quantile=\"0.99\"} %lu\n",
+           (unsigned long)loopLatencyPercentile(0.5f), (unsigned long)loopLatencyPercentile(0.9f), (unsigned long)loopLatencyPercentile(0.99f));
+  w.printf("# TYPE cage_loop_latency_max_us gauge\ncage_loop_latency_max_us %lu\n", (unsigned long)loopMaxUsPrev);
+
+  // --- [추가] 태스크 (controlTask / loop) ---
+  struct { const char* name; TaskHandle_t h; const TaskStat* st; } tasks[] = {
+    { "control", controlTaskHandle, &controlTaskStat },
+    { "loop",    loopTaskHandle,    &loopTaskStat },
+  };
+  w.printf("# TYPE cage_task_stack_free_bytes gauge\n");
+  for (auto &t : tasks) if (t.h) w.printf("cage_task_stack_free_bytes{task=\"%s\"} %lu\n", t.name, (unsigned long)uxTaskGetStackHighWaterMark(t.h));
+  w.printf("# TYPE cage_task_cycles_total counter\n");
+  for (auto &t : tasks) w.printf("cage_task_cycles_total{task=\"%s\"} %lu\n", t.name, (unsigned long)t.st->cycles);
+  w.printf("# TYPE cage_task_cycle_max_us gauge\n");
+  for (auto &t : tasks) w.printf("cage_task_cycle_max_us{task=\"%s\"} %lu\n", t.name, (unsigned long)t.st->maxCycleUs);
+  w.printf("# TYPE cage_task_queue_drops_total counter\n");
+  for (auto &t : tasks) w.printf("cage_task_queue_drops_total{task=\"%s\"} %lu\n", t.name, (unsigned long)t.st->queueDrops);
+  w.printf("# TYPE cage_task_idle_ms_total counter\n");                    // [추가] 이벤트/마감을 기다리며 잠든 시간
+  for (auto &t : tasks) w.printf("cage_task_idle_ms_total{task=\"%s\"} %llu\n", t.name, (unsigned long long)(t.st->idleUs / 1000));
+  w.printf("# TYPE cage_state_read_retries_total counter\ncage_state_read_retries_total %lu\n", (unsigned long)cageStateRetries.load());
+
+  w.printf("# TYPE cage_humidifier_start_sequences_total counter\ncage_humidifier_start_sequences_total %lu\n", (unsigned long)humiSeqStarts);
+
+  // --- [추가] 엔코더/버튼 입력 ---
+  w.printf("# TYPE cage_encoder_steps_total counter\ncage_encoder_steps_total %lu\n", (unsigned long)encSteps);
+  w.printf("# TYPE cage_encoder_glitches_total counter\ncage_encoder_glitches_total %lu\n", (unsigned long)encGlitches);
+  w.printf("# TYPE cage_button_events_total counter\ncage_button_events_total %lu\n", (unsigned long)btnEvents);
+  w.printf("# TYPE cage_button_drops_total counter\ncage_button_drops_total %lu\n", (unsigned long)btnDrops);
+
+  // --- [추가] 마감시각 스케줄러 ---
+  const Scheduler* scheds[] = { &ctlSched, &loopSched };
+  const char* schedNames[] = { "control", "loop" };
+  w.printf("# TYPE cage_sched_idle_ms gauge\n");
+  for (int k = 0; k < 2; k++) w.printf("cage_sched_idle_ms{task=\"%s\"} %lu\n", schedNames[k], (unsigned long)scheds[k]->idleMs);
+  w.printf("# TYPE cage_sched_job_runs_total counter\n");
+  for (int k = 0; k < 2; k++)
+    for (int i = 0; i < scheds[k]->count; i++)
+      w.printf("cage_sched_job_runs_total{task=\"%s\",job=\"%s\"} %lu\n", schedNames[k], scheds[k]->jobs[i].name, (unsigned long)scheds[k]->jobs[i].runs);
+  w.printf("# TYPE cage_sched_job_late_max_ms gauge\n");
+  for (int k = 0; k < 2; k++)
+    for (int i = 0; i < scheds[k]->count; i++)
+      w.printf("cage_sched_job_late_max_ms{task=\"%s\",job=\"%s\"} %lu\n", schedNames[k], scheds[k]->jobs[i].name, (unsigned long)scheds[k]->jobs[i].lateMaxMs);
+
+  // --- LCD 렌더링 ---
+  w.printf("# TYPE cage_ui_pixels_pushed_total counter\ncage_ui_pixels_pushed_total %llu\n", (unsigned long long)uiStats.totalPixels);
+  w.printf("# TYPE cage_ui_frames_total counter\ncage_ui_frames_total %lu\n", (unsigned long)uiStats.frames);
+  w.printf("# TYPE cage_ui_frame_pixels gauge\n"
+           "cage_ui_frame_pixels{stat=\"last\"} %lu\n"
+           "cage_ui_frame_pixels{stat=\"max\"} %lu\n",
+           (unsigned long)uiStats.lastFramePixels, (unsigned long)uiStats.maxFramePixels);
+  w.printf("# TYPE cage_ui_graph_frame_us gauge\n"
+           "cage_ui_graph_frame_us{stat=\"last\"} %lu\n"
+           "cage_ui_graph_frame_us{stat=\"max\"} %lu\n",
+           (unsigned long)uiStats.graphFrameUs, (unsigned long)uiStats.graphFrameMaxUs);
+  w.printf("# TYPE cage_ui_graph_blocking_us gauge\n"
+           "cage_ui_graph_blocking_us{stat=\"last\"} %lu\n"
+           "cage_ui_graph_blocking_us{stat=\"max\"} %lu\n",
+           (unsigned long)uiStats.graphBlockUs, (unsigned long)uiStats.graphBlockMaxUs);
+  w.printf("# TYPE cage_ui_graph_push_us gauge\n"
+           "cage_ui_graph_push_us{stat=\"last\"} %lu\n"
+           "cage_ui_graph_push_us{stat=\"max\"} %lu\n",
+           (unsigned long)uiStats.graphPushUs, (unsigned long)uiStats.graphPushMaxUs);
+  w.printf("# TYPE cage_graph_sprite_bytes gauge\ncage_graph_sprite_bytes{bpp=\"%d\"} %lu\n", GRAPH_SPRITE_BPP, (unsigned long)graphSpriteBytes);
+  w.printf("# TYPE cage_hist_active gauge\ncage_hist_active %d\n", histView.active ? 1 : 0);
+  w.printf("# TYPE cage_hist_pages_total counter\n"
+           "cage_hist_pages_total{result=\"hit\"} %lu\n"
+           "cage_hist_pages_total{result=\"miss\"} %lu\n"
+           "cage_hist_pages_total{result=\"prefetch\"} %lu\n",
+           (unsigned long)histView.hits, (unsigned long)histView.misses, (unsigned long)histView.prefetches);
+  w.printf("# TYPE cage_hist_stall_us_total counter\ncage_hist_stall_us_total %lu\n", (unsigned long)histView.stallUs);
+  w.printf("# TYPE cage_hist_stall_max_us gauge\ncage_hist_stall_max_us %lu\n", (unsigned long)histView.stallMaxUs);
+  w.printf("# TYPE cage_graph_y_axis gauge\n");
+  static const char* const SERIES_NAMES[NUM_GRAPH_SERIES] = { "temp", "humi" };
+  for (int s = 0; s < NUM_GRAPH_SERIES; s++) {
+    w.printf("cage_graph_y_axis{series=\"%s\",bound=\"min\"} %.1f\ncage_graph_y_axis{series=\"%s\",bound=\"max\"} %.1f\n",
+             SERIES_NAMES[s], graphYAxis[s].lo10 / 10.0, SERIES_NAMES[s], graphYAxis[s].hi10 / 10.0);
+  }
+  w.printf("# TYPE cage_graph_y_rescales_total counter\ncage_graph_y_rescales_total %lu\n", (unsigned long)graphYRescales);
+  w.printf("# TYPE cage_graph_sprite_reclaimed_bytes gauge\ncage_graph_sprite_reclaimed_bytes %ld\n", (long)graphSpriteReclaimedBytes);
+  w.printf("# TYPE cage_ui_frame_budget_us gauge\ncage_ui_frame_budget_us %d\n", UI_FRAME_BUDGET_US);
+  w.printf("# TYPE cage_ui_frames_over_budget_total counter\ncage_ui_frames_over_budget_total %lu\n", (unsigned long)uiStats.overBudgetFrames);
+  w.printf("# TYPE cage_ui_loop_budget_us gauge\ncage_ui_loop_budget_us %d\n", UI_LOOP_BUDGET_US);
+  w.printf("# TYPE cage_ui_job_runs_total counter\n");
+  for (int i = 0; i < NUM_UI_JOBS; i++) w.printf("cage_ui_job_runs_total{job=\"%s\"} %lu\n", uiJobs[i].name, (unsigned long)uiJobs[i].runs);
+  w.printf("# TYPE cage_ui_job_deferrals_total counter\n");
+  for (int i = 0; i < NUM_UI_JOBS; i++) w.printf("cage_ui_job_deferrals_total{job=\"%s\"} %lu\n", uiJobs[i].name, (unsigned long)uiJobs[i].deferrals);
+  w.printf("# TYPE cage_ui_job_us gauge\n");
+  for (int i = 0; i < NUM_UI_JOBS; i++) {
+    w.printf("cage_ui_job_us{job=\"%s\",stat=\"avg\"} %lu\ncage_ui_job_us{job=\"%s\",stat=\"max\"} %lu\n",
+             uiJobs[i].name, (unsigned long)uiJobs[i].estUs, uiJobs[i].name, (unsigned long)uiJobs[i].maxUs);
+  }
+  w.printf("# TYPE cage_ui_widget_repaints_total counter\n");
+  for (int i = 0; i < NUM_UI_WIDGETS; i++) {
+    w.printf("cage_ui_widget_repaints_total{widget=\"%s\"} %lu\n", uiWidgets[i].name, (unsigned long)uiWidgets[i].repaints);
+  }
+  w.printf("# TYPE cage_ui_widget_skips_total counter\n");
+  for (int i = 0; i < NUM_UI_WIDGETS; i++) {
+    w.printf("cage_ui_widget_skips_total{widget=\"%s\"} %lu\n", uiWidgets[i].name, (unsigned long)uiWidgets[i].skips);
+  }
+
+  // --- 플래시 로그 ---
+  w.printf("# TYPE cage_log_head_index gauge\ncage_log_head_index %lu\n", (unsigned long)logMeta.head_index);
+  w.printf("# TYPE cage_log_record_count gauge\ncage_log_record_count %lu\n", (unsigned long)logMeta.record_count);
+
+  // --- HTTP ---
+  w.printf("# TYPE cage_http_requests_total counter\n");
+  for (int i = 0; i < httpRouteCount; i++) {
+    w.printf("cage_http_requests_total{path=\"%s\"} %lu\n", httpRouteStats[i].path, (unsigned long)httpRouteStats[i].requests);
+  }
+  w.printf("# TYPE cage_http_response_bytes_total counter\n");
+  for (int i = 0; i < httpRouteCount; i++) {
+    w.printf("cage_http_response_bytes_total{path=\"%s\"} %lu\n", httpRouteStats[i].path, (unsigned long)httpRouteStats[i].bytes);
+  }
+  w.printf("# TYPE cage_http_handler_max_seconds gauge\n");
+  for (int i = 0; i < httpRouteCount; i++) {
+    w.printf("cage_http_handler_max_seconds{path=\"%s\"} %.3f\n", httpRouteStats[i].path, httpRouteStats[i].maxUs / 1e6);
+  }
+  w.printf("# TYPE cage_http_handler_seconds histogram\n");
+  for (int i = 0; i < httpRouteCount; i++) {
+    const HttpRouteStat &st = httpRouteStats[i];
+    uint32_t cum = 0;
+    for (int b = 0; b < HTTP_HIST_BUCKETS - 1; b++) {
+      cum += st.hist[b];
+      w.printf("cage_http_handler_seconds_bucket{path=\"%s\",le=\"%.3f\"} %lu\n", st.path, (2UL << b) / 1000.0, (unsigned long)cum);
+    }
+    w.printf("cage_http_handler_seconds_bucket{path=\"%s\",le=\"+Inf\"} %lu\n", st.path, (unsigned long)st.requests);
+    w.printf("cage_http_handler_seconds_sum{path=\"%s\"} %.3f\n", st.path, st.totalUs / 1e6);
+    w.printf("cage_http_handler_seconds_count{path=\"%s\"} %lu\n", st.path, (unsigned long)st.requests);
+  }
+  w.printf("# TYPE cage_metrics_truncated_total counter\ncage_metrics_truncated_total %lu\n", (unsigned long)metricsTruncated);
+
+  w.flush();
+  server.sendContent("");
+}
+
+
+
+// [추가] 라우트별 처리시간/전송량 표 (/debug/http)
+void handleDebugHttp() {
+  server.sendHeader("Connection", "close");
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/html; charset=UTF-8", "");
+
+  MetricsWriter w;
+  w.printf("<!DOCTYPE html><html><head><title>HTTP Stats</title><meta charset=\"UTF-8\"><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\"><style>"
+           "body{font-family:sans-serif;background-color:#f4f4f4;margin:0;padding:10px;color:#333}"
+           "table{border-collapse:collapse;background:#fff;font-size:0.8em}th,td{border:1px solid #ddd;padding:4px 6px;text-align:right}"
+           "th{background:#007bff;color:#fff}td:first-child{text-align:left}"
+           "</style></head><body><h2>HTTP Handler Stats</h2><table><tr><th>Path</th><th>Req</th><th>Bytes</th><th>Avg ms</th><th>Max ms</th>");
+  for (int b = 0; b < HTTP_HIST_BUCKETS; b++) {
+    if (b == HTTP_HIST_BUCKETS - 1) w.printf("<th>&ge;%lu</th>", 1UL << b);
+    else w.printf("<th>&lt;%lu</th>", 2UL << b);
+  }
+  w.printf("</tr>");
+
+  for (int i = 0; i < httpRouteCount; i++) {
+    const HttpRouteStat &st = httpRouteStats[i];
+    w.printf("<tr><td>%s</td><td>%lu</td><td>%lu</td><td>%.1f</td><td>%.1f</td>", st.path,
+             (unsigned long)st.requests, (unsigned long)st.bytes,
+             st.requests ? st.totalUs / 1000.0 / st.requests : 0.0, st.maxUs / 1000.0);
+    for (int b = 0; b < HTTP_HIST_BUCKETS; b++) w.printf("<td>%lu</td>", (unsigned long)st.hist[b]);
+    w.printf("</tr>");
+  }
+  w.printf("</table><p>Histogram columns: handler time in ms.</p></body></html>");
+
+  w.flush();
+  server.sendContent("");
+}
+
+
+
+
+
+
+// [추가] 그래프 스프라이트를 BMP 로 내려받기 (/debug/graph.bmp)
+// 기기에 쌓인 실제 데이터로 그린 합성 버퍼(+ 모드 표시)를 24비트 BMP 로 한 줄씩 전송 (골든 이미지 비교는 host/ 빌드)
+void handleGraphBmp() {
+  int w = layout->graph_w, h = layout->graph_h;
+  uint32_t rowBytes = (w * 3 + 3) & ~3u;                        // BMP 한 줄은 4바이트 정렬
+  uint32_t imageBytes = rowBytes * h;
+  uint32_t fileBytes = 54 + imageBytes;
+  int tw = graphTagSprite.width(), th = graphTagSprite.height();
+
+  uint8_t hdr[54] = { 'B', 'M' };
+  auto put32 = [&](int off, uint32_t v) { for (int i = 0; i < 4; i++) hdr[off + i] = (v >> (8 * i)) & 0xFF; };
+  put32(2, fileBytes);
+  put32(10, 54);                                                // 픽셀 데이터 시작
+  put32(14, 40);                                                // BITMAPINFOHEADER
+  put32(18, w);
+  put32(22, h);
+  hdr[26] = 1;                                                  // planes
+  hdr[28] = 24;                                                 // bpp
+  put32(34, imageBytes);
+
+  tftSync();                                                    // 전송 중인 스트립과 섞이지 않도록
+  server.sendHeader("Connection", "close");
+  server.sendHeader("Content-Disposition", "inline; filename=graph.bmp");
+  server.setContentLength(fileBytes);
+  server.send(200, "image/bmp", "");
+  server.sendContent((const char*)hdr, sizeof(hdr));
+
+  uint8_t line[320 * 3 + 4];
+  for (int y = h - 1; y >= 0; y--) {                            // BMP 는 아래 줄부터
+    memset(line, 0, rowBytes);
+    for (int x = 0; x < w; x++) {
+      bool inTag = x >= GRAPH_TAG_X && x < GRAPH_TAG_X + tw && y >= GRAPH_TAG_Y && y < GRAPH_TAG_Y + th;
+      uint16_t c = inTag ? graphTagSprite.readPixel(x - GRAPH_TAG_X, y - GRAPH_TAG_Y) : graphSprite.readPixel(x, y);
+      line[x * 3 + 0] = (c << 3) & 0xF8;                         // B
+      line[x * 3 + 1] = (c >> 3) & 0xFC;                         // G
+      line[x * 3 + 2] = (c >> 8) & 0xF8;                         // R
+    }
+    server.sendContent((const char*)line, rowBytes);
+    if ((y & 15) == 0) yield();
+  }
+}
+
+// [추가] 화면 요소별 렌더링 시간 (/debug/renderbench, ?rot=both 이면 가로/세로 모두)
+// 각 요소를 무효화한 뒤 전체 다시 그리는 시간 (그래프는 DMA 전송 완료까지, 스크롤 경로는 별도)
+// SPI 전송을 포함한 실제 기기 시간, 그리기 코드만의 시간은 host/ 빌드의 render_test --bench
+void handleRenderBench() {
+  const int REPS = 8;
+  int origRot = screenRotation;
+  bool both = server.hasArg("rot") && server.arg("rot") == "both";
+
+  server.sendHeader("Connection", "close");
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/plain", "");
+
+  MetricsWriter w;
+  w.printf("reps=%d sprite_bpp=%d dma=%d glyph_cache=%d\n", REPS, GRAPH_SPRITE_BPP, graphFlush.dma ? 1 : 0, glyphCacheReady ? 1 : 0);
+  w.printf("rot  element        avg_us   max_us\n");
+
+  for (int pass = 0; pass < (both ? 2 : 1); pass++) {
+    if (pass == 1) {
+      screenRotation = origRot ^ 1;
+      applyScreenRotation();
+    }
+
+    for (int e = 0; e < 5; e++) {
+      static const char* const names[] = { "graph_full", "graph_scroll", "face", "icons", "readouts" };
+      uint32_t total = 0, maxUs = 0;
+      for (int r = 0; r < REPS; r++) {
+        switch (e) {
+          case 0: invalidateGraph(); break;
+          case 2: invalidateWidget(W_FACE); break;
+          case 3: for (int id = W_ICON_LED; id <= W_ICON_FAN; id++) invalidateWidget(id); break;
+          case 4: for (int id = W_TIME; id <= W_HUMI; id++) invalidateWidget(id); break;
+        }
+        tftSync();
+        unsigned long t0 = micros();
+        switch (e) {
+          case 0:
+          case 1:
+            drawGraph();
+            while (graphFlush.active) graphFlushPump();
+            break;
+          case 2: drawConditionFace(); break;
+          case 3: drawStatusIcons(); break;
+          case 4: { CageState st = readState(); drawTimeTempHumi(st.temp, st.humi); break; }
+        }
+        tftSync();
+        uint32_t us = micros() - t0;
+        total += us;
+        if (us > maxUs) maxUs = us;
+        esp_task_wdt_reset();
+      }
+      w.printf("%3d  %-12s  %7lu  %7lu\n", screenRotation, names[e], (unsigned long)(total / REPS), (unsigned long)maxUs);
+      yield();
+    }
+  }
+
+  if (screenRotation != origRot) {
+    screenRotation = origRot;
+    applyScreenRotation();
+  }
+
+  w.flush();
+  server.sendContent("");
+}
+
+
+
+
+
+
 // =========================================
 void setup() {
+  Serial.begin(115200);
 
   // [추가] 와치독 타이머 초기화 (가장 먼저 실행)
   esp_task_wdt_init(WDT_TIMEOUT, true); 
@@ -2851,7 +5662,7 @@ void setup() {
   pinMode(ENCODER_CLK, INPUT_PULLUP);
   pinMode(ENCODER_DT,  INPUT_PULLUP);
   pinMode(ENCODER_SW,  INPUT_PULLUP);
-  lastEncState = (digitalRead(ENCODER_CLK) << 1) | digitalRead(ENCODER_DT);
+  startInputIsr();                          // [추가] 엔코더 인터럽트 + 버튼 디바운스 타이머
   
   pinMode(LED1_PIN, OUTPUT);
   pinMode(LED2_PIN, OUTPUT);
@@ -2888,9 +5699,8 @@ void setup() {
 
 
   tft.init();
-  // 스프라이트 초기화 (메모리 할당)
-  graphSprite.setColorDepth(16); // 16비트 컬러
-  graphSprite.createSprite(layout_graph_w, layout_graph_h);     // 그래프 크기만큼 생성
+  graphFlush.dma = tft.initDMA();                               // [추가] 그래프 비동기 전송용
+  initGlyphCache();                                             // [추가] 정보줄 숫자 글리프
 
   //tft.setRotation(SCREEN_ROTATION);
   tft.fillScreen(BG_COLOR);
@@ -2899,10 +5709,8 @@ void setup() {
   updateLayout(); 
   tft.setRotation(screenRotation); // 0 or 1
 
-  // 스프라이트 크기 재설정 (가로/세로 크기에 맞춰 다시 생성)
-  graphSprite.deleteSprite();                                   // 기존꺼 삭제
-  graphSprite.setColorDepth(16);
-  graphSprite.createSprite(layout_graph_w, layout_graph_h);     // 변수 사용
+  // 스프라이트 초기화 (가로/세로 크기에 맞춰 생성)
+  createGraphSprite();
 
 
 
@@ -2970,20 +5778,27 @@ void setup() {
 
 
   startAP();
-  server.on("/", HTTP_GET, [](){ handleRoot(false); });
-  server.on("/login", HTTP_POST, handleLogin);
-  server.on("/dashboard", HTTP_GET, handleDashboard);
-  server.on("/config", HTTP_GET, handleConfig);
-  server.on("/ntpconfig", HTTP_GET, handleNTPConfig);
-  server.on("/remote", HTTP_GET, handleRemote);
-  server.on("/setterminal", HTTP_POST, handleSetTerminal);          // (가습기,히터,팬 통합)
-  server.on("/sensorconfig", HTTP_GET, handleSensorConfig);
-  server.on("/sensorsave", HTTP_POST, handleSensorSave);
-  server.on("/save", HTTP_POST, handleSave);
-  server.on("/ntpsave", HTTP_POST, handleNTPSave);
-  server.on("/downloadlog", HTTP_GET, handleDownloadLog);
-  server.on("/sensordata", HTTP_GET, handleSensorData);
-  server.on("/graphdata", HTTP_GET, handleGraphData);               // [추가] 그래프 데이터 요청
+  onRoute("/", HTTP_GET, [](){ handleRoot(false); });
+  onRoute("/login", HTTP_POST, handleLogin);
+  onRoute("/dashboard", HTTP_GET, handleDashboard);
+  onRoute("/config", HTTP_GET, handleConfig);
+  onRoute("/ntpconfig", HTTP_GET, handleNTPConfig);
+  onRoute("/remote", HTTP_GET, handleRemote);
+  onRoute("/setterminal", HTTP_POST, handleSetTerminal);          // (가습기,히터,팬 통합)
+  onRoute("/sensorconfig", HTTP_GET, handleSensorConfig);
+  onRoute("/sensorsave", HTTP_POST, handleSensorSave);
+  onRoute("/save", HTTP_POST, handleSave);
+  onRoute("/ntpsave", HTTP_POST, handleNTPSave);
+  onRoute("/downloadlog", HTTP_GET, handleDownloadLog);
+  onRoute("/sensordata", HTTP_GET, handleSensorData);
+  onRoute("/graphdata", HTTP_GET, handleGraphData);               // [추가] 그래프 데이터 요청
+  onRoute("/sw.js", HTTP_GET, handleServiceWorker);               // [추가] 대시보드 서비스워커
+  onRoute("/metrics", HTTP_GET, handleMetrics);                    // [추가] Prometheus 메트릭
+  onRoute("/debug/http", HTTP_GET, handleDebugHttp);               // [추가] 라우트별 처리시간 통계
+  onRoute("/debug/renderbench", HTTP_GET, handleRenderBench);       // [추가] 화면 요소별 렌더링 시간
+  onRoute("/debug/graph.bmp", HTTP_GET, handleGraphBmp);            // [추가] 그래프 화면 덤프
+  onRoute("/update", HTTP_GET, handleOtaPage);                      // [추가] 펌웨어 업데이트 (OTA)
+  onRoute("/update", HTTP_POST, handleOtaFinish, handleOtaUpload);
   server.begin();
   delay(50);
   if (savedSsid.length() > 0) {
@@ -2994,162 +5809,55 @@ void setup() {
   delay(50);
   externalAPConnected = (WiFi.status() == WL_CONNECTED);
   delay(50);
+
+  startControlTask();                       // [추가] 센서/제어는 여기서부터 core 0 태스크에서
+  schedStart(loopSched, millis(), 100);
 }
 
 
 
 
 // =============================================================================================================================
+// [추가] loop() 끝에서 할 일이 없으면 min(다음 스케줄 마감, LOOP_WEB_POLL_MS) 동안 잠듦 (바쁘게 돌며 CPU 를 쓰지 않음)
+// 엔코더 ISR, 버튼 타이머, controlTask 의 uiPost 가 태스크 알림으로 바로 깨움
+// WebServer 는 요청이 와도 깨울 방법이 없어 LOOP_WEB_POLL_MS 마다 handleClient
+#define LOOP_WEB_POLL_MS 10
+
+void loopIdleWait() {
+  if (uiPendingJobs || graphFlush.active) return;              // 밀린 화면 작업, 진행 중인 그래프 전송
+  uint32_t waitMs = min(loopSched.idleMs, (uint32_t)LOOP_WEB_POLL_MS);
+  if (waitMs == 0) return;
+  unsigned long t0 = micros();
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+  loopTaskStat.idleUs += micros() - t0;
+}
+
 void loop() {
   unsigned long nowMs = millis();
+  unsigned long loopStartUs = micros();
   
   server.handleClient();
-  handleEncoderButton();
-
-
-  // Check for manual humidifier auto-off
-  //////////////////////////////////////////////////////////////////////////////////////////////////////////
-  if (humidifierMode == ON && manualHumidifierStartTime != 0) {
-    if ((millis() - manualHumidifierStartTime) >= (HUMIDIFIER_AUTO_OFF_MINUTES * 60 * 1000UL)) {
-      humidifierOff();
-      humidifierMode = OFF;                                                 // 상태변경
-      manualHumidifierStartTime = 0;
-      preferences.begin("Storage", false);                                  // 상태저장
-      preferences.putInt("humiMode", static_cast<int>(humidifierMode));
-      preferences.end();
-    }
-  }
-  //////////////////////////////////////////////////////////////////////////////////////////////////////////
-  if (heaterMode == ON &&  manualHeaterStartTime != 0) {
-    if ((millis() - manualHeaterStartTime) >= (HEATER_AUTO_OFF_MINUTES * 60 * 1000UL)) {
-      heaterOff();
-      heaterMode = OFF;                       // 수동 OFF 상태로 변경
-      manualHeaterStartTime = 0;
-      preferences.begin("Storage", false);
-      preferences.putInt("heatMode", static_cast<int>(heaterMode));
-      preferences.end();
-   }
-  }
-  //////////////////////////////////////////////////////////////////////////////////////////////////////////
-  if (fanMode == ON && manualFanStartTime != 0) {
-    if ((millis() - manualFanStartTime) >= (FAN_AUTO_OFF_MINUTES * 60 * 1000UL)) {
-      fanOff();
-      fanMode = OFF;                          // 수동 OFF 상태로 변경
-      manualFanStartTime = 0;
-      preferences.begin("Storage", false);
-      preferences.putInt("fanMode", static_cast<int>(fanMode));
-      preferences.end();
-   }
-  }
-  //////////////////////////////////////////////////////////////////////////////////////////////////////////
+  drainUiEvents();                                              // [추가] controlTask 이벤트 (화면 갱신, 그래프 샘플)
+  graphFlushPump();                                             // [추가] 그래프 DMA 전송 이어가기
+  histPrefetchPump();                                           // [추가] 히스토리 화면 좌우 페이지 미리 읽기
+  handleInputEvents();                                          // [수정] 엔코더/버튼은 ISR 이 넣은 이벤트로 처리
 
 
 
-  // Handle system info display overlay
-  if (sysInfoDisplayUntil > 0) {
-    if (nowMs >= sysInfoDisplayUntil) {
-      sysInfoDisplayUntil = 0;
-      tft.fillScreen(BG_COLOR);                     // 화면 초기화
-      drawTitle();
-      drawTimeTempHumi(lastTemp, lastHumi, true);
-      drawConditionFace();
-      drawStatusIcons();
-      drawGraphFrame();
-      drawGraph();
-    }
-    //return; // Do nothing else while info is displayed
-    // [수정] 여기에 있던 return; 을 삭제함
-    // 이유: 이걸 지워야 정보창이 떠 있는 3초 동안에도 히터 제어와 웹서버가 멈추지 않음.  => 1초 주기로 디스플레이 작동으로 화면깨짐발생 (추가수정요망) 
-  }
-  
-
-  handleEncoderRotation();
   ntpUpdate();
 
+  // [수정] 정보창 닫기, WiFi 재연결, 바람개비, 통계 출력은 마감시각 스케줄러로 (마감된 것만 실행)
+  // 센서 측정/제어와 그래프 샘플 평균은 controlTask 에서 (drainUiEvents 로 결과를 받음)
+  schedRun(loopSched, nowMs);
 
-// --- [수정] WiFi 자동 재연결 로직 (30초마다 체크) ---
-  static unsigned long lastWifiCheck = 0;
-  const unsigned long WIFI_CHECK_INTERVAL = 30000;
-  
-  if (nowMs - lastWifiCheck >= WIFI_CHECK_INTERVAL) {
-    lastWifiCheck = nowMs;
-    
-    // 와이파이가 끊겨 있고, 설정된 SSID가 있다면
-    if (WiFi.status() != WL_CONNECTED && savedSsid.length() > 0) {
-       Serial.println("WiFi lost. Reconnecting...");
-       WiFi.disconnect(); // 기존 연결 시도 끊기
-       WiFi.begin(savedSsid.c_str(), savedPass.c_str()); // 처음부터 다시 시작
-    }
-  }
-
-
-
-
-
-  if (nowMs - lastSample >= SAMPLE_INTERVAL) {
-      lastSample = nowMs;
-      float temperature, humidity;
-      if (readSensor(temperature, humidity)) {
-          lastTemp = temperature; lastHumi = humidity;
-          accTemp += temperature; accHumi += humidity; accCount++;
-      } else { lastTemp = NAN; lastHumi = NAN; }
-
-
-    // [수정] 정보창이 떠 있지 않을 때만 메인 화면 갱신
-    if (sysInfoDisplayUntil == 0) {
-        drawTimeTempHumi(lastTemp, lastHumi, true);
-        drawConditionFace();
-        drawStatusIcons();
-    }
-
-  checkHumidity();
-  checkTemperature();
-  // 온도,습도가 높으면 FAN 가동할 것, checkHumidity() + checkTemperature() => checkEnvironment() 
-  }
-
-
-
-
-  if (nowMs - lastGraphSampleMs >= GRAPH_SAMPLE_INTERVAL_SEC * 1000UL) {
-      lastGraphSampleMs = nowMs;
-      float avgTemp = (accCount > 0) ? (accTemp / accCount) : NAN;
-      float avgHumi = (accCount > 0) ? (accHumi / accCount) : NAN;
-      
-      pushToDisplayBuffer(avgTemp, avgHumi);
-
-      accTemp = 0; accHumi = 0; accCount = 0;
-
-      // [수정] 정보창이 떠 있지 않을 때만 그래프 그리기
-      if (sysInfoDisplayUntil == 0) {
-          drawGraph();
-      }
-  }
-
-
-
-  // --- 바람개비 부드러운 애니메이션 (0.1초 간격) ---
-  static unsigned long lastFanAnimMs = 0;
-  
-  if (nowMs - lastFanAnimMs >= 100) { // 100ms 마다 갱신
-    lastFanAnimMs = nowMs;
-
-
-
-
-
-    // [수정] 정보창이 없고, 팬이 켜져 있을 때만 그리기
-    if (sysInfoDisplayUntil == 0 && fanMode != OFF && digitalRead(FAN_PIN) == HIGH) {
-      
-      int fanX = 210; 
-      if (screenRotation == 1) {
-          fanX += 75; // 가로 모드 보정
-      }
-      int fanY = layout_icons_y + 6 + 2; 
-
-      drawSpinningFan(fanX, fanY, 12, TFT_GREEN); 
-    }
-  }
+  uiSchedule(loopStartUs);                      // [추가] 요청된 화면 갱신을 시간 예산 안에서 실행
+  uiEndFrame();
+  recordLoopLatency(micros() - loopStartUs);
+  uint32_t loopUs = micros() - loopStartUs;
+  if (loopUs > loopTaskStat.maxCycleUs) loopTaskStat.maxCycleUs = loopUs;
+  loopTaskStat.cycles++;
 
   esp_task_wdt_reset();           // [추가] 와치독 타이머에게 "나 살아있다"고 신호 보냄
+  loopIdleWait();                 // [추가] 할 일이 없으면 다음 마감까지 잠듦
 
 }